@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    BiquadBank.h
+    a runtime sized set of biquads (the extra peak, shelf and notch bands) that the cascade
+    runs after its fixed stages. every coefficient and every state lives in its own flat array,
+    sized once in prepare, and the bands that are switched on sit packed at the front
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+template <typename SampleType>
+class BiquadBank
+{
+public:
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int laneCount = (int) Register::size();
+
+    //allocates. room for maxBands bands on numGroups lane groups, with none of them switched on yet
+    void prepare(int maxBandsToUse, size_t numGroupsToUse)
+    {
+        maxBands = maxBandsToUse;
+        numGroups = numGroupsToUse;
+        numActive = 0;
+
+        const auto zero = Register::expand(0);
+        for (auto* coefficient : { &b0, &b1, &b2, &a1, &a2 })
+            coefficient->assign((size_t) maxBands, zero);
+
+        //one row of maxBands states per group
+        s1.assign(numGroups * (size_t) maxBands, zero);
+        s2.assign(numGroups * (size_t) maxBands, zero);
+
+        bandAtPosition.assign((size_t) maxBands, -1);
+        positionOfBand.assign((size_t) maxBands, -1);
+    }
+
+    void reset() noexcept
+    {
+        std::fill(s1.begin(), s1.end(), Register::expand(0));
+        std::fill(s2.begin(), s2.end(), Register::expand(0));
+    }
+
+    int getNumActiveBands() const noexcept { return numActive; }
+    bool contains(int band) const noexcept { return positionOfBand[(size_t) band] >= 0; }
+
+    //new coefficients for a band. one that wasn't running yet goes on the end and starts from silence
+    void setBand(int band, const BiquadArray& biquad) noexcept
+    {
+        auto position = positionOfBand[(size_t) band];
+
+        if (position < 0)
+        {
+            jassert(numActive < maxBands);
+            position = numActive++;
+            positionOfBand[(size_t) band] = position;
+            bandAtPosition[(size_t) position] = band;
+
+            for (size_t group = 0; group < numGroups; ++group)
+                s1[getStateIndex(group, position)] = s2[getStateIndex(group, position)] = Register::expand(0);
+        }
+
+        const auto p = (size_t) position;
+        b0[p] = Register::expand((SampleType) biquad[0]);
+        b1[p] = Register::expand((SampleType) biquad[1]);
+        b2[p] = Register::expand((SampleType) biquad[2]);
+        a1[p] = Register::expand((SampleType) biquad[3]);
+        a2[p] = Register::expand((SampleType) biquad[4]);
+    }
+
+    //takes a band out and closes the gap. everything behind it moves up one place, coefficients and state together, so
+    //every other band keeps seeing the same input it did before (swapping the last one in would reorder them)
+    void removeBand(int band) noexcept
+    {
+        const auto position = positionOfBand[(size_t) band];
+        if (position < 0)
+            return;
+
+        for (int p = position; p < numActive - 1; ++p)
+            moveBand(p + 1, p);
+
+        --numActive;
+        bandAtPosition[(size_t) numActive] = -1;
+        positionOfBand[(size_t) band] = -1;
+    }
+
+    //same as FilterCascade::copyChannelState
+    void copyChannelState(int fromChannel, int toChannel) noexcept
+    {
+        const auto fromGroup = (size_t) (fromChannel / laneCount), toGroup = (size_t) (toChannel / laneCount);
+        const auto fromLane = (size_t) (fromChannel % laneCount), toLane = (size_t) (toChannel % laneCount);
+
+        for (int p = 0; p < numActive; ++p)
+        {
+            s1[getStateIndex(toGroup, p)].set(toLane, s1[getStateIndex(fromGroup, p)].get(fromLane));
+            s2[getStateIndex(toGroup, p)].set(toLane, s2[getStateIndex(fromGroup, p)].get(fromLane));
+        }
+    }
+
+    //one band at a time over the whole run of samples. the band count is only known at runtime, so rather than a loop over
+    //bands inside every sample (where the state would have to go back to memory each time) each band keeps its coefficients
+    //and state in registers for the whole pass, and the samples stay in cache from one band to the next
+    void process(Register* samples, size_t numSamples, size_t group) noexcept
+    {
+        auto* groupS1 = s1.data() + group * (size_t) maxBands;
+        auto* groupS2 = s2.data() + group * (size_t) maxBands;
+
+        for (size_t p = 0; p < (size_t) numActive; ++p)
+        {
+            const auto c0 = b0[p], c1 = b1[p], c2 = b2[p], d1 = a1[p], d2 = a2[p];
+            auto z1 = groupS1[p], z2 = groupS2[p];
+
+            //same transposed direct form II as processCascade
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto x = samples[i];
+                const auto y = c0 * x + z1;
+                z1 = c1 * x - d1 * y + z2;
+                z2 = c2 * x - d2 * y;
+                samples[i] = y;
+            }
+
+            groupS1[p] = z1;
+            groupS2[p] = z2;
+        }
+    }
+
+private:
+    size_t getStateIndex(size_t group, int position) const noexcept { return group * (size_t) maxBands + (size_t) position; }
+
+    void moveBand(int from, int to) noexcept
+    {
+        const auto f = (size_t) from, t = (size_t) to;
+        b0[t] = b0[f];
+        b1[t] = b1[f];
+        b2[t] = b2[f];
+        a1[t] = a1[f];
+        a2[t] = a2[f];
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            s1[getStateIndex(group, to)] = s1[getStateIndex(group, from)];
+            s2[getStateIndex(group, to)] = s2[getStateIndex(group, from)];
+        }
+
+        const auto band = bandAtPosition[f];
+        bandAtPosition[t] = band;
+        positionOfBand[(size_t) band] = to;
+    }
+
+    int maxBands { 0 }, numActive { 0 };
+    size_t numGroups { 0 };
+
+    //structure of arrays: position p of each array is the p-th running band
+    std::vector<Register> b0, b1, b2, a1, a2;
+    std::vector<Register> s1, s2;
+
+    //which band sits where, -1 for an empty position / a band that isn't running
+    std::vector<int> bandAtPosition, positionOfBand;
+};
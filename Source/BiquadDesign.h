@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+    the same peak and butterworth designs juce's IIR::Coefficients / FilterDesign give us,
+    but written straight into plain arrays so they never allocate (safe on the audio thread)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//b0, b1, b2, a1, a2 with a0 divided out, same layout as juce::dsp::IIR::Coefficients.
+//kept in double: steep low cuts at high rates put the poles right next to 1, and rounding them to float shifts the response.
+//the float kernel rounds them once when they get broadcast, the double kernel uses them as they are
+using BiquadArray = std::array<double, 5>;
+
+inline BiquadArray normaliseBiquad(double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+{
+    const auto a0Inv = 1.0 / a0;
+    return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+}
+
+//same maths as IIR::Coefficients::makePeakFilter
+inline BiquadArray designPeakBiquad(double sampleRate, double frequency, double quality, double gainFactor) noexcept
+{
+    jassert(sampleRate > 0 && frequency > 0 && frequency <= sampleRate * 0.5 && quality > 0);
+
+    const auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+    const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto alpha = std::sin(omega) / (quality * 2.0);
+    const auto c2 = -2.0 * std::cos(omega);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+
+    return normaliseBiquad(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+//same maths as IIR::Coefficients::makeLowShelf
+inline BiquadArray designLowShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor) noexcept
+{
+    jassert(sampleRate > 0 && frequency > 0 && frequency <= sampleRate * 0.5 && quality > 0);
+
+    const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+    const auto aMinus1 = A - 1.0, aPlus1 = A + 1.0;
+    const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+    const auto coso = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCoso = aMinus1 * coso;
+
+    return normaliseBiquad(A * (aPlus1 - aMinus1TimesCoso + beta), A * 2.0 * (aMinus1 - aPlus1 * coso), A * (aPlus1 - aMinus1TimesCoso - beta),
+                           aPlus1 + aMinus1TimesCoso + beta, -2.0 * (aMinus1 + aPlus1 * coso), aPlus1 + aMinus1TimesCoso - beta);
+}
+
+//same maths as IIR::Coefficients::makeHighShelf
+inline BiquadArray designHighShelfBiquad(double sampleRate, double frequency, double quality, double gainFactor) noexcept
+{
+    jassert(sampleRate > 0 && frequency > 0 && frequency <= sampleRate * 0.5 && quality > 0);
+
+    const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+    const auto aMinus1 = A - 1.0, aPlus1 = A + 1.0;
+    const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+    const auto coso = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aMinus1TimesCoso = aMinus1 * coso;
+
+    return normaliseBiquad(A * (aPlus1 + aMinus1TimesCoso + beta), A * -2.0 * (aMinus1 + aPlus1 * coso), A * (aPlus1 + aMinus1TimesCoso - beta),
+                           aPlus1 - aMinus1TimesCoso + beta, 2.0 * (aMinus1 - aPlus1 * coso), aPlus1 - aMinus1TimesCoso - beta);
+}
+
+//same maths as IIR::Coefficients::makeNotch
+inline BiquadArray designNotchBiquad(double sampleRate, double frequency, double quality) noexcept
+{
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+    const auto b0 = c1 * (1.0 + nSquared);
+    const auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+    return { b0, b1, b0, b1, c1 * (1.0 - n * invQ + nSquared) };
+}
+
+//the steepest cut there is, 96db/oct
+static constexpr int maxButterworthOrder = 16;
+
+//q of every section of every even order butterworth up to maxButterworthOrder, same as FilterDesign::design*HighOrderButterworthMethod.
+//worked out once when the plugin loads, so a redesign in the middle of a ramp doesn't pay a cos per section
+struct ButterworthQualities {
+    ButterworthQualities() noexcept
+    {
+        for (int order = 2; order <= maxButterworthOrder; order += 2)
+            for (int index = 0; index < order / 2; ++index)
+                qualities[(size_t) (order / 2 - 1)][(size_t) index]
+                    = 1.0 / (2.0 * std::cos((2.0 * index + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+    }
+
+    std::array<std::array<double, maxButterworthOrder / 2>, maxButterworthOrder / 2> qualities {};
+};
+
+inline const ButterworthQualities butterworthQualities;
+
+//q of section "index" in an even order butterworth
+inline double butterworthSectionQuality(int order, int index) noexcept
+{
+    jassert(order > 0 && order % 2 == 0 && order <= maxButterworthOrder && index < order / 2);
+    return butterworthQualities.qualities[(size_t) (order / 2 - 1)][(size_t) index];
+}
+
+//same maths as IIR::Coefficients::makeHighPass
+inline BiquadArray designHighPassBiquad(double sampleRate, double frequency, double quality) noexcept
+{
+    const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normaliseBiquad(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+}
+
+//same maths as IIR::Coefficients::makeLowPass
+inline BiquadArray designLowPassBiquad(double sampleRate, double frequency, double quality) noexcept
+{
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+    const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+    return normaliseBiquad(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+}
+
+//fills the first order / 2 sections of a butterworth high pass (low cut) or low pass (high cut)
+template <size_t MaxSections>
+void designButterworthSections(std::array<BiquadArray, MaxSections>& sections, bool isHighPass,
+                               double sampleRate, double frequency, int order) noexcept
+{
+    jassert(order / 2 <= (int) MaxSections);
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        const auto q = butterworthSectionQuality(order, i);
+        sections[(size_t) i] = isHighPass ? designHighPassBiquad(sampleRate, frequency, q)
+                                          : designLowPassBiquad(sampleRate, frequency, q);
+    }
+}
+
+//a dry / wet crossfade folded into the biquad itself: the poles stay where they are and the numerator moves towards
+//the denominator, which is exactly (1 - amount) * x + amount * biquad(x). amount 0 passes everything straight through
+inline BiquadArray fadeBiquad(const BiquadArray& biquad, double amount) noexcept
+{
+    const auto a1 = biquad[3], a2 = biquad[4];
+    return { 1.0 + amount * (biquad[0] - 1.0), a1 + amount * (biquad[1] - a1), a2 + amount * (biquad[2] - a2), a1, a2 };
+}
+
+//radius of the biquad's slowest pole (the roots of z^2 + a1 z + a2)
+inline double getPoleRadius(const BiquadArray& biquad) noexcept
+{
+    const auto a1 = biquad[3], a2 = biquad[4];
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    //complex pair, both at sqrt(a2)
+    if (discriminant < 0)
+        return std::sqrt(a2);
+
+    const auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+//how long whatever is left in the state takes to die away by the given amount (a positive number of decibels)
+inline double getDecaySamples(double poleRadius, double decibels) noexcept
+{
+    if (poleRadius <= 0)
+        return 0;
+
+    jassert(poleRadius < 1.0);
+    return decibels / (-20.0 * std::log10(poleRadius));
+}
+
+//a cascade only settles once every stage before the last one has, so the stages' decay times add up
+inline double getCascadeDecaySamples(const BiquadArray* biquads, int numBiquads, double decibels) noexcept
+{
+    double samples = 0;
+    for (int i = 0; i < numBiquads; ++i)
+        samples += getDecaySamples(getPoleRadius(biquads[i]), decibels);
+    return samples;
+}
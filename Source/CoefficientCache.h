@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    remembers recently designed bands so automation sweeps that keep revisiting
+    the same settings skip the trig and butterworth pole placement.
+    only for settled designs on the message thread: the keys round to the
+    parameter steps, which is too coarse for the smoothed values in a ramp
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterCascade.h"
+
+class CoefficientCache
+{
+public:
+    //every parameter is stepped (1hz, 0.5db, 0.05 q), so rounding to those steps gives exact integer keys
+    struct Key {
+        int band { 0 }, slope { 0 };
+        int frequency { 0 }, halfDecibels { 0 }, qualityTwentieths { 0 };
+        double sampleRate { 0 };
+
+        bool operator== (const Key& other) const noexcept
+        {
+            return band == other.band && slope == other.slope && frequency == other.frequency
+                && halfDecibels == other.halfDecibels && qualityTwentieths == other.qualityTwentieths
+                && sampleRate == other.sampleRate;
+        }
+    };
+
+    //what one band designs into: the peak uses the first biquad, a cut uses slope + 1 of them
+    using Biquad = BiquadArray;
+    using Entry = std::array<Biquad, maxCutSections>;
+
+    //everything is allocated here, find and insert never allocate
+    explicit CoefficientCache(int capacityToUse = 512)
+        : capacity(juce::jmax(1, capacityToUse)),
+          numBuckets(juce::nextPowerOfTwo(capacity * 2)),
+          slots((size_t) capacity),
+          buckets((size_t) numBuckets, none)
+    {
+        clear();
+    }
+
+    //returns nullptr on a miss. a hit becomes the most recently used entry
+    const Entry* find(const Key& key) noexcept
+    {
+        for (auto index = buckets[bucketFor(key)]; index != none; index = slots[(size_t) index].nextInBucket)
+        {
+            if (slots[(size_t) index].key == key)
+            {
+                ++hits;
+                moveToFront(index);
+                return &slots[(size_t) index].entry;
+            }
+        }
+
+        ++misses;
+        return nullptr;
+    }
+
+    //stores a freshly designed band, pushing out the least recently used one when full
+    void insert(const Key& key, const Entry& entry) noexcept
+    {
+        int index;
+
+        if (numUsed < capacity)
+        {
+            index = numUsed++;
+        }
+        else
+        {
+            index = leastRecent;
+            unlinkFromBucket(index);
+            unlinkFromList(index);
+            ++evictions;
+        }
+
+        auto& slot = slots[(size_t) index];
+        slot.key = key;
+        slot.entry = entry;
+
+        auto& bucket = buckets[bucketFor(key)];
+        slot.nextInBucket = bucket;
+        bucket = index;
+
+        linkAtFront(index);
+    }
+
+    void clear() noexcept
+    {
+        std::fill(buckets.begin(), buckets.end(), none);
+        numUsed = 0;
+        mostRecent = leastRecent = none;
+    }
+
+    int getHits() const noexcept { return hits.get(); }
+    int getMisses() const noexcept { return misses.get(); }
+    int getEvictions() const noexcept { return evictions.get(); }
+
+private:
+    static constexpr int none = -1;
+
+    struct Slot {
+        Key key;
+        Entry entry {};
+        int nextInBucket { none }, newer { none }, older { none };
+    };
+
+    size_t bucketFor(const Key& key) const noexcept
+    {
+        auto hash = (juce::uint32) key.band * 0x9e3779b1u;
+        hash = (hash ^ (juce::uint32) key.slope) * 0x85ebca6bu;
+        hash = (hash ^ (juce::uint32) key.frequency) * 0xc2b2ae35u;
+        hash = (hash ^ (juce::uint32) key.halfDecibels) * 0x27d4eb2fu;
+        hash = (hash ^ (juce::uint32) key.qualityTwentieths) * 0x165667b1u;
+        hash = (hash ^ (juce::uint32) juce::roundToInt(key.sampleRate)) * 0x9e3779b1u;
+        return (size_t) ((hash ^ (hash >> 15)) & (juce::uint32) (numBuckets - 1));
+    }
+
+    void unlinkFromBucket(int index) noexcept
+    {
+        auto* link = &buckets[bucketFor(slots[(size_t) index].key)];
+        while (*link != index)
+            link = &slots[(size_t) *link].nextInBucket;
+        *link = slots[(size_t) index].nextInBucket;
+    }
+
+    void unlinkFromList(int index) noexcept
+    {
+        auto& slot = slots[(size_t) index];
+        if (slot.newer != none) slots[(size_t) slot.newer].older = slot.older; else mostRecent = slot.older;
+        if (slot.older != none) slots[(size_t) slot.older].newer = slot.newer; else leastRecent = slot.newer;
+    }
+
+    void linkAtFront(int index) noexcept
+    {
+        auto& slot = slots[(size_t) index];
+        slot.newer = none;
+        slot.older = mostRecent;
+        if (mostRecent != none) slots[(size_t) mostRecent].newer = index; else leastRecent = index;
+        mostRecent = index;
+    }
+
+    void moveToFront(int index) noexcept
+    {
+        if (index == mostRecent)
+            return;
+
+        unlinkFromList(index);
+        linkAtFront(index);
+    }
+
+    const int capacity, numBuckets;
+    std::vector<Slot> slots;
+    std::vector<int> buckets;
+    int numUsed { 0 }, mostRecent { none }, leastRecent { none };
+    juce::Atomic<int> hits, misses, evictions;
+
+    JUCE_DECLARE_NON_COPYABLE (CoefficientCache)
+};
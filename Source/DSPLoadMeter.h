@@ -0,0 +1,315 @@
+/*
+  ==============================================================================
+
+    DSPLoadMeter.h
+    how long each processBlock takes next to how long it was allowed to take. the audio thread
+    reads the clock twice and bumps a few counters in fixed histograms, nothing else, so it can
+    stay on in a release build. any other thread can read the numbers whenever it likes
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DSPLoadMeter
+{
+public:
+    //load is the time a block took over the time its samples last at the host's rate, so 1 means it only just made it.
+    //counted in 1% steps up to maxLoad, anything past that lands in the last bin
+    static constexpr int loadBinsPerUnit = 100;
+    static constexpr int maxLoad = 2;
+    static constexpr int numLoadBins = loadBinsPerUnit * maxLoad + 1;
+
+    //block times in nanoseconds on a log scale: the highest set bit picks the octave and the subBinBits below it
+    //split that into 8 steps, so a bin is never more than 12.5% wide and finding one costs no log
+    static constexpr int subBinBits = 3;
+    static constexpr int numTimeBins = (32 - subBinBits + 1) << subBinBits;
+
+    //a copy of everything, worked out on the reading thread
+    struct Stats {
+        juce::uint64 numBlocks { 0 }, numSamples { 0 };
+        //blocks that took longer than their deadline
+        juce::uint64 numOverruns { 0 };
+        double meanMicroseconds { 0 }, p99Microseconds { 0 }, maxMicroseconds { 0 };
+        //fractions of the deadline
+        double meanLoad { 0 }, p99Load { 0 }, maxLoad { 0 };
+        //bands redesigned on the audio thread in the middle of a ramp
+        juce::uint64 numAudioThreadDesigns { 0 };
+        //bands redesigned on the message thread, per ChainPositions (the meter doesn't know about these, its owner fills them in)
+        std::array<int, 3> redesignCounts {};
+        std::array<juce::uint64, numLoadBins> loadHistogram {};
+    };
+
+    DSPLoadMeter() { clear(); }
+
+    //message thread, while the audio thread isn't running. the deadline for n samples is n / sampleRate
+    void prepare(double sampleRate)
+    {
+        samplesPerNanosecond = sampleRate / 1.0e9;
+        clear();
+    }
+
+    //any thread: the audio thread clears everything before its next block
+    void reset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    //while it's off the audio thread only reads this flag
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    //audio thread: times everything from here to the end of the scope as one block of numSamples
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(DSPLoadMeter& meterToUse, int numSamplesToUse) noexcept
+            : meter(meterToUse.isEnabled() ? &meterToUse : nullptr), numSamples(numSamplesToUse),
+              startTicks(meter != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedBlock()
+        {
+            if (meter != nullptr)
+                meter->addBlock(juce::Time::getHighResolutionTicks() - startTicks, numSamples);
+        }
+
+    private:
+        DSPLoadMeter* meter;
+        int numSamples;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    //audio thread
+    void addDesign() noexcept { increment(numDesigns); }
+
+    //any thread. the counters are read one at a time, so a block that lands halfway through can be in some of them and
+    //not others, which is fine for a meter
+    Stats getStats() const
+    {
+        Stats stats;
+        stats.numBlocks = numBlocks.load(std::memory_order_relaxed);
+        stats.numSamples = totalSamples.load(std::memory_order_relaxed);
+        stats.numOverruns = numOverruns.load(std::memory_order_relaxed);
+        stats.numAudioThreadDesigns = numDesigns.load(std::memory_order_relaxed);
+
+        if (stats.numBlocks == 0)
+            return stats;
+
+        const auto blocks = (double) stats.numBlocks;
+        stats.meanMicroseconds = (double) totalNanoseconds.load(std::memory_order_relaxed) / blocks * 1.0e-3;
+        stats.maxMicroseconds = (double) maxNanoseconds.load(std::memory_order_relaxed) * 1.0e-3;
+        stats.meanLoad = (double) totalLoadPpm.load(std::memory_order_relaxed) / blocks * 1.0e-6;
+        stats.maxLoad = (double) maxLoadPpm.load(std::memory_order_relaxed) * 1.0e-6;
+
+        std::array<juce::uint64, numTimeBins> timeHistogram;
+        for (size_t bin = 0; bin < timeHistogram.size(); ++bin)
+            timeHistogram[bin] = timeBins[bin].load(std::memory_order_relaxed);
+        for (size_t bin = 0; bin < stats.loadHistogram.size(); ++bin)
+            stats.loadHistogram[bin] = loadBins[bin].load(std::memory_order_relaxed);
+
+        //the top edge of the bin the 99th percentile falls in, so it never reads better than it was.
+        //capped at the max, which is exact (the last load bin and the widest time bins can go well past it)
+        stats.p99Microseconds = juce::jmin(stats.maxMicroseconds, (double) getTimeBinEnd(getPercentileBin(timeHistogram, 0.99)) * 1.0e-3);
+        stats.p99Load = juce::jmin(stats.maxLoad, (double) (getPercentileBin(stats.loadHistogram, 0.99) + 1) / loadBinsPerUnit);
+        return stats;
+    }
+
+    //one line per Stats, same columns as getCSVHeader
+    static juce::String getCSVHeader()
+    {
+        return "blocks,samples,overruns,mean_us,p99_us,max_us,mean_load,p99_load,max_load,"
+               "audio_thread_designs,lowcut_redesigns,peak_redesigns,highcut_redesigns";
+    }
+
+    static juce::String toCSVRow(const Stats& stats)
+    {
+        juce::StringArray columns;
+        columns.add(juce::String(stats.numBlocks));
+        columns.add(juce::String(stats.numSamples));
+        columns.add(juce::String(stats.numOverruns));
+        for (auto value : { stats.meanMicroseconds, stats.p99Microseconds, stats.maxMicroseconds })
+            columns.add(juce::String(value, 3));
+        for (auto value : { stats.meanLoad, stats.p99Load, stats.maxLoad })
+            columns.add(juce::String(value, 6));
+        columns.add(juce::String(stats.numAudioThreadDesigns));
+        for (auto count : stats.redesignCounts)
+            columns.add(juce::String(count));
+        return columns.joinIntoString(",");
+    }
+
+    //the same numbers plus the load histogram, trimmed after its last non empty bin
+    static juce::var toJSON(const Stats& stats)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("blocks", (juce::int64) stats.numBlocks);
+        object->setProperty("samples", (juce::int64) stats.numSamples);
+        object->setProperty("overruns", (juce::int64) stats.numOverruns);
+        object->setProperty("meanMicroseconds", stats.meanMicroseconds);
+        object->setProperty("p99Microseconds", stats.p99Microseconds);
+        object->setProperty("maxMicroseconds", stats.maxMicroseconds);
+        object->setProperty("meanLoad", stats.meanLoad);
+        object->setProperty("p99Load", stats.p99Load);
+        object->setProperty("maxLoad", stats.maxLoad);
+        object->setProperty("audioThreadDesigns", (juce::int64) stats.numAudioThreadDesigns);
+
+        juce::Array<juce::var> redesigns;
+        for (auto count : stats.redesignCounts)
+            redesigns.add(count);
+        object->setProperty("redesigns", redesigns);
+
+        auto numBins = stats.loadHistogram.size();
+        while (numBins > 0 && stats.loadHistogram[numBins - 1] == 0)
+            --numBins;
+
+        juce::Array<juce::var> histogram;
+        for (size_t bin = 0; bin < numBins; ++bin)
+            histogram.add((juce::int64) stats.loadHistogram[bin]);
+        object->setProperty("loadHistogramPercent", histogram);
+
+        return juce::var(object);
+    }
+
+    //a list of Stats, each one labelled (a file name, a benchmark case...) in a first column / property called labelName.
+    //json if the file says so, csv otherwise
+    static bool writeToFile(const juce::File& file, const juce::String& labelName,
+                            const juce::StringArray& labels, const std::vector<Stats>& stats)
+    {
+        jassert(labels.size() == (int) stats.size());
+
+        if (file.hasFileExtension("json"))
+        {
+            juce::Array<juce::var> entries;
+            for (size_t i = 0; i < stats.size(); ++i)
+            {
+                auto entry = toJSON(stats[i]);
+                entry.getDynamicObject()->setProperty(labelName, labels[(int) i]);
+                entries.add(entry);
+            }
+
+            return file.replaceWithText(juce::JSON::toString(entries));
+        }
+
+        juce::String csv;
+        csv << labelName << "," << getCSVHeader() << "\n";
+        for (size_t i = 0; i < stats.size(); ++i)
+            csv << labels[(int) i].quoted() << "," << toCSVRow(stats[i]) << "\n";
+
+        return file.replaceWithText(csv);
+    }
+
+private:
+    using Counter = std::atomic<juce::uint64>;
+
+    //only the audio thread writes, so a plain load and store is enough and there's no locked read-modify-write
+    static void increment(Counter& counter, juce::uint64 amount = 1) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void raise(Counter& counter, juce::uint64 value) noexcept
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+
+    static int getTimeBin(juce::uint64 nanoseconds) noexcept
+    {
+        const auto ns = (juce::uint32) juce::jmin(nanoseconds, (juce::uint64) std::numeric_limits<juce::uint32>::max());
+        if (ns < (1u << subBinBits))
+            return (int) ns;
+
+        const auto octave = juce::findHighestSetBit(ns);
+        const auto shift = octave - subBinBits;
+        return ((shift + 1) << subBinBits) | (int) ((ns >> shift) & ((1u << subBinBits) - 1));
+    }
+
+    //one past the largest time that lands in the bin
+    static juce::uint64 getTimeBinEnd(int bin) noexcept
+    {
+        const auto octaveBin = bin >> subBinBits;
+        if (octaveBin == 0)
+            return (juce::uint64) bin + 1;
+
+        const auto shift = octaveBin - 1;
+        const auto start = (juce::uint64) ((1 << subBinBits) | (bin & ((1 << subBinBits) - 1))) << shift;
+        return start + ((juce::uint64) 1 << shift);
+    }
+
+    template <size_t NumBins>
+    static int getPercentileBin(const std::array<juce::uint64, NumBins>& histogram, double fraction) noexcept
+    {
+        juce::uint64 total = 0;
+        for (auto count : histogram)
+            total += count;
+
+        const auto wanted = (juce::uint64) std::ceil((double) total * fraction);
+        juce::uint64 seen = 0;
+        for (size_t bin = 0; bin < NumBins; ++bin)
+        {
+            seen += histogram[bin];
+            if (seen >= wanted && seen > 0)
+                return (int) bin;
+        }
+
+        return 0;
+    }
+
+    void addBlock(juce::int64 ticks, int numSamples) noexcept
+    {
+        if (resetRequested.load(std::memory_order_acquire))
+        {
+            resetRequested.store(false, std::memory_order_relaxed);
+            clear();
+        }
+
+        if (numSamples <= 0)
+            return;
+
+        const auto nanoseconds = (juce::uint64) ((double) juce::jmax((juce::int64) 0, ticks) * nanosecondsPerTick);
+        const auto load = (double) nanoseconds * samplesPerNanosecond / numSamples;
+        const auto loadPpm = (juce::uint64) (load * 1.0e6);
+
+        increment(numBlocks);
+        increment(totalSamples, (juce::uint64) numSamples);
+        increment(totalNanoseconds, nanoseconds);
+        increment(totalLoadPpm, loadPpm);
+        raise(maxNanoseconds, nanoseconds);
+        raise(maxLoadPpm, loadPpm);
+
+        if (load > 1.0)
+            increment(numOverruns);
+
+        increment(timeBins[(size_t) getTimeBin(nanoseconds)]);
+        increment(loadBins[(size_t) juce::jmin(numLoadBins - 1, (int) (load * loadBinsPerUnit))]);
+    }
+
+    //audio thread, or before it starts
+    void clear() noexcept
+    {
+        for (auto* counter : { &numBlocks, &totalSamples, &numOverruns, &totalNanoseconds, &maxNanoseconds,
+                               &totalLoadPpm, &maxLoadPpm, &numDesigns })
+            counter->store(0, std::memory_order_relaxed);
+
+        for (auto& bin : timeBins)
+            bin.store(0, std::memory_order_relaxed);
+        for (auto& bin : loadBins)
+            bin.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> enabled { true }, resetRequested { false };
+    double samplesPerNanosecond { 44100.0 / 1.0e9 };
+
+    const double nanosecondsPerTick { 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond() };
+
+    Counter numBlocks, totalSamples, numOverruns, numDesigns;
+    Counter totalNanoseconds, maxNanoseconds;
+    //loads in parts per million, so the sums stay integers
+    Counter totalLoadPpm, maxLoadPpm;
+    std::array<Counter, numTimeBins> timeBins;
+    std::array<Counter, numLoadBins> loadBins;
+
+    JUCE_DECLARE_NON_COPYABLE (DSPLoadMeter)
+};
@@ -0,0 +1,756 @@
+/*
+  ==============================================================================
+
+    FilterCascade.h
+    fused biquad kernel that runs the whole low cut -> peak -> high cut chain
+    per sample, on one SIMDRegister of channels at a time
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+#include "SVFDesign.h"
+#include "BiquadBank.h"
+
+//the kernel runs in whatever precision the host renders in: float packs 4 channels per register (sse/neon), double 2
+template <typename SampleType>
+using CascadeRegister = juce::dsp::SIMDRegister<SampleType>;
+using FloatRegister = CascadeRegister<float>;
+
+//fixed slots for every biquad the chain can use. bypassed stages just keep their slot,
+//so their state doesn't move around when a slope changes (same as the old ProcessorChain)
+static constexpr int maxCutStages = 4;
+static constexpr int lowCutSlot = 0;
+static constexpr int peakSlot = lowCutSlot + maxCutStages;
+static constexpr int highCutSlot = peakSlot + 1;
+static constexpr int numKernelSlots = highCutSlot + maxCutStages;
+
+//the fused kernels stop at maxCutStages sections per cut (48db/oct). steeper slopes go up to maxCutSections,
+//and the sections past the kernel's get slots of their own after it, run by a runtime length loop
+static constexpr int maxCutSections = maxButterworthOrder / 2;
+static constexpr int numExtraCutSections = maxCutSections - maxCutStages;
+static constexpr int extraLowCutSlot = numKernelSlots;
+static constexpr int extraHighCutSlot = extraLowCutSlot + numExtraCutSections;
+static constexpr int maxCascadeStages = extraHighCutSlot + numExtraCutSections;
+
+//where section "section" of each cut lives
+constexpr int getLowCutSlot(int section) noexcept
+{
+    return section < maxCutStages ? lowCutSlot + section : extraLowCutSlot + section - maxCutStages;
+}
+
+constexpr int getHighCutSlot(int section) noexcept
+{
+    return section < maxCutStages ? highCutSlot + section : extraHighCutSlot + section - maxCutStages;
+}
+
+//which slots a kernel runs, in processing order: the low cuts, the peak, then the high cuts.
+//any band can be left out completely (0 stages) while it's transparent
+template <int NumLowCut, int NumPeak, int NumHighCut>
+struct CascadeLayout {
+    static_assert(NumLowCut >= 0 && NumLowCut <= maxCutStages && NumPeak >= 0 && NumPeak <= 1
+                  && NumHighCut >= 0 && NumHighCut <= maxCutStages, "cut filters run up to maxCutStages stages, the peak one");
+
+    static constexpr int numStages = NumLowCut + NumPeak + NumHighCut;
+    //zero length arrays aren't allowed, an empty kernel just never touches its one slot
+    static constexpr int arraySize = numStages > 0 ? numStages : 1;
+
+    static constexpr int slotFor(int stage)
+    {
+        return stage < NumLowCut ? lowCutSlot + stage
+             : stage < NumLowCut + NumPeak ? peakSlot
+             : highCutSlot + stage - NumLowCut - NumPeak;
+    }
+};
+
+//kernel tables are indexed by (low cut count, peak count, high cut count)
+static constexpr int numCutCounts = maxCutStages + 1;
+static constexpr int numKernelLayouts = numCutCounts * 2 * numCutCounts;
+
+constexpr int getKernelLayoutIndex(int numLowCut, int numPeak, int numHighCut) noexcept
+{
+    return (numLowCut * 2 + numPeak) * numCutCounts + numHighCut;
+}
+
+//one biquad's coefficients with each value already copied into every lane
+template <typename SampleType>
+struct SIMDBiquadCoefficients {
+    CascadeRegister<SampleType> b0, b1, b2, a1, a2;
+};
+
+//b0, b1, b2, a1, a2 like juce stores them (a0 already divided out). the designs are always double,
+//this is the only place they get rounded to the sample type
+template <typename SampleType>
+SIMDBiquadCoefficients<SampleType> broadcastBiquad(const BiquadArray& biquad) noexcept
+{
+    using Register = CascadeRegister<SampleType>;
+    return { Register::expand((SampleType) biquad[0]),
+             Register::expand((SampleType) biquad[1]),
+             Register::expand((SampleType) biquad[2]),
+             Register::expand((SampleType) biquad[3]),
+             Register::expand((SampleType) biquad[4]) };
+}
+
+//the whole chain's coefficients. one of these is shared by every lane group
+template <typename SampleType>
+struct CascadeCoefficients {
+    std::array<SIMDBiquadCoefficients<SampleType>, maxCascadeStages> stages;
+};
+
+//transposed direct form II state for every slot, for one lane group
+template <typename SampleType>
+struct CascadeState {
+    std::array<CascadeRegister<SampleType>, maxCascadeStages> s1, s2;
+
+    void reset() noexcept
+    {
+        s1.fill(CascadeRegister<SampleType>::expand(0));
+        s2.fill(CascadeRegister<SampleType>::expand(0));
+    }
+};
+
+//runs every active stage on a sample before moving to the next one, so the block is read and written once
+//and the stage count is known at compile time, which lets the compiler unroll the stages and keep the state in registers
+template <typename SampleType, int NumLowCut, int NumPeak, int NumHighCut>
+void processCascade(CascadeRegister<SampleType>* samples, size_t numSamples,
+                    const CascadeCoefficients<SampleType>& coefficients, CascadeState<SampleType>& state) noexcept
+{
+    using Layout = CascadeLayout<NumLowCut, NumPeak, NumHighCut>;
+    using Register = CascadeRegister<SampleType>;
+    constexpr int numStages = Layout::numStages;
+
+    //everything elided, the samples already are the output
+    if constexpr (numStages == 0)
+        return;
+
+    //pull everything into locals for the length of the block
+    Register b0[Layout::arraySize], b1[Layout::arraySize], b2[Layout::arraySize], a1[Layout::arraySize], a2[Layout::arraySize];
+    Register s1[Layout::arraySize], s2[Layout::arraySize];
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto slot = Layout::slotFor(stage);
+        const auto& c = coefficients.stages[(size_t) slot];
+        b0[stage] = c.b0;
+        b1[stage] = c.b1;
+        b2[stage] = c.b2;
+        a1[stage] = c.a1;
+        a2[stage] = c.a2;
+        s1[stage] = state.s1[(size_t) slot];
+        s2[stage] = state.s2[(size_t) slot];
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+
+        //same maths as juce::dsp::IIR::Filter for a second order section
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            const auto y = b0[stage] * x + s1[stage];
+            s1[stage] = b1[stage] * x - a1[stage] * y + s2[stage];
+            s2[stage] = b2[stage] * x - a2[stage] * y;
+            x = y;
+        }
+
+        samples[i] = x;
+    }
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto slot = Layout::slotFor(stage);
+        state.s1[(size_t) slot] = s1[stage];
+        state.s2[(size_t) slot] = s2[stage];
+    }
+}
+
+template <typename SampleType>
+using CascadeKernel = void (*)(CascadeRegister<SampleType>*, size_t, const CascadeCoefficients<SampleType>&, CascadeState<SampleType>&);
+
+//one instantiation per (low cut, peak, high cut) stage count, looked up when a slope changes or a band gets elided
+//rather than every block
+template <typename SampleType, int... Index>
+constexpr std::array<CascadeKernel<SampleType>, sizeof...(Index)> makeCascadeKernelTable(std::integer_sequence<int, Index...>) noexcept
+{
+    return { processCascade<SampleType, Index / (2 * numCutCounts), (Index / numCutCounts) % 2, Index % numCutCounts>... };
+}
+
+template <typename SampleType>
+CascadeKernel<SampleType> getCascadeKernel(int numLowCut, int numPeak, int numHighCut) noexcept
+{
+    static constexpr auto kernels = makeCascadeKernelTable<SampleType>(std::make_integer_sequence<int, numKernelLayouts> {});
+
+    jassert(numLowCut >= 0 && numLowCut <= maxCutStages && numPeak >= 0 && numPeak <= 1 && numHighCut >= 0 && numHighCut <= maxCutStages);
+    return kernels[(size_t) getKernelLayoutIndex(numLowCut, numPeak, numHighCut)];
+}
+
+//the state variable version of a stage: g, k, m0, m1, m2 copied into every lane
+template <typename SampleType>
+struct SIMDSVFCoefficients {
+    CascadeRegister<SampleType> g, k, m0, m1, m2;
+};
+
+template <typename SampleType>
+SIMDSVFCoefficients<SampleType> broadcastSVF(const SVFArray& svf) noexcept
+{
+    using Register = CascadeRegister<SampleType>;
+    return { Register::expand((SampleType) svf[0]),
+             Register::expand((SampleType) svf[1]),
+             Register::expand((SampleType) svf[2]),
+             Register::expand((SampleType) svf[3]),
+             Register::expand((SampleType) svf[4]) };
+}
+
+//a ramping svf works its integrator gains out again from g and k this often. SIMDRegister can't divide,
+//so it's one division per lane per stage, and a few samples at the same cutoff don't make any difference
+static constexpr size_t svfRebuildInterval = 8;
+
+//a1 = 1 / (1 + g (g + k)), a2 = g a1, a3 = g a2, lane by lane
+template <typename SampleType>
+void makeSVFIntegratorGains(const CascadeRegister<SampleType>& g, const CascadeRegister<SampleType>& k, CascadeRegister<SampleType>& a1,
+                            CascadeRegister<SampleType>& a2, CascadeRegister<SampleType>& a3) noexcept
+{
+    for (size_t lane = 0; lane < CascadeRegister<SampleType>::size(); ++lane)
+        a1.set(lane, (SampleType) 1 / ((SampleType) 1 + g.get(lane) * (g.get(lane) + k.get(lane))));
+
+    a2 = g * a1;
+    a3 = g * a2;
+}
+
+template <typename SampleType>
+struct CascadeSVFCoefficients {
+    std::array<SIMDSVFCoefficients<SampleType>, maxCascadeStages> stages;
+};
+
+//same stage layout and order as processCascade, but every stage is a trapezoidal svf (s1 and s2 hold the two integrator states).
+//with Interpolate on, the call is rampPosition samples into a ramp of rampLength samples that starts at start and moves by
+//increment every sample. g, k and the mix gains follow that line, so a ramp is smooth at audio rate instead of stepping once per
+//update interval. the integrator gains get rebuilt from g and k on a svfRebuildInterval grid counted from the start of the ramp,
+//so each filter along the way is a proper tpt svf (which stays stable however fast its cutoff moves), and every value only
+//depends on where in the ramp it is, not on how the ramp got split into calls
+template <typename SampleType, int NumLowCut, int NumPeak, int NumHighCut, bool Interpolate>
+void processSVFCascade(CascadeRegister<SampleType>* samples, size_t numSamples,
+                       const CascadeSVFCoefficients<SampleType>& start, const CascadeSVFCoefficients<SampleType>& increment,
+                       CascadeState<SampleType>& state, size_t rampPosition, size_t rampLength) noexcept
+{
+    using Layout = CascadeLayout<NumLowCut, NumPeak, NumHighCut>;
+    using Register = CascadeRegister<SampleType>;
+    constexpr int numStages = Layout::numStages;
+
+    if constexpr (numStages == 0)
+        return;
+
+    constexpr auto size = Layout::arraySize;
+    Register g[size], k[size], a1[size], a2[size], a3[size], m0[size], m1[size], m2[size];
+    Register dg[size], dk[size], dm0[size], dm1[size], dm2[size];
+    Register ic1[size], ic2[size];
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto slot = (size_t) Layout::slotFor(stage);
+        const auto& c = start.stages[slot];
+        g[stage] = c.g;
+        k[stage] = c.k;
+        m0[stage] = c.m0;
+        m1[stage] = c.m1;
+        m2[stage] = c.m2;
+
+        if constexpr (Interpolate)
+        {
+            const auto& d = increment.stages[slot];
+            dg[stage] = d.g;
+            dk[stage] = d.k;
+            dm0[stage] = d.m0;
+            dm1[stage] = d.m1;
+            dm2[stage] = d.m2;
+        }
+        else
+        {
+            makeSVFIntegratorGains<SampleType>(g[stage], k[stage], a1[stage], a2[stage], a3[stage]);
+        }
+
+        ic1[stage] = state.s1[slot];
+        ic2[stage] = state.s2[slot];
+    }
+
+    const auto two = Register::expand((SampleType) 2);
+
+    for (size_t i = 0; i < numSamples; )
+    {
+        auto chunkEnd = numSamples;
+
+        //each chunk runs at the cutoff and damping its last sample would have had, so the last one lands on the target
+        if constexpr (Interpolate)
+        {
+            const auto position = rampPosition + i;
+            const auto rampChunkEnd = juce::jmin((position / svfRebuildInterval + 1) * svfRebuildInterval, rampLength);
+            chunkEnd = juce::jmin(i + rampChunkEnd - position, numSamples);
+
+            const auto steps = Register::expand((SampleType) rampChunkEnd);
+            for (int stage = 0; stage < numStages; ++stage)
+                makeSVFIntegratorGains<SampleType>(g[stage] + dg[stage] * steps, k[stage] + dk[stage] * steps,
+                                                   a1[stage], a2[stage], a3[stage]);
+        }
+
+        for (; i < chunkEnd; ++i)
+        {
+            auto x = samples[i];
+            Register steps {};
+            if constexpr (Interpolate)
+                steps = Register::expand((SampleType) (rampPosition + i + 1));
+
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                //the mix gains are linear in the output, they can keep moving every sample
+                auto mix0 = m0[stage], mix1 = m1[stage], mix2 = m2[stage];
+                if constexpr (Interpolate)
+                {
+                    mix0 += dm0[stage] * steps;
+                    mix1 += dm1[stage] * steps;
+                    mix2 += dm2[stage] * steps;
+                }
+
+                //v1 is the band pass output, v2 the low pass, both integrators updated trapezoidally
+                const auto v3 = x - ic2[stage];
+                const auto v1 = a1[stage] * ic1[stage] + a2[stage] * v3;
+                const auto v2 = ic2[stage] + a2[stage] * ic1[stage] + a3[stage] * v3;
+                ic1[stage] = two * v1 - ic1[stage];
+                ic2[stage] = two * v2 - ic2[stage];
+                x = mix0 * x + mix1 * v1 + mix2 * v2;
+            }
+
+            samples[i] = x;
+        }
+    }
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        const auto slot = (size_t) Layout::slotFor(stage);
+        state.s1[slot] = ic1[stage];
+        state.s2[slot] = ic2[stage];
+    }
+}
+
+template <typename SampleType>
+using CascadeSVFKernel = void (*)(CascadeRegister<SampleType>*, size_t, const CascadeSVFCoefficients<SampleType>&,
+                                  const CascadeSVFCoefficients<SampleType>&, CascadeState<SampleType>&, size_t, size_t);
+
+template <typename SampleType, bool Interpolate, int... Index>
+constexpr std::array<CascadeSVFKernel<SampleType>, sizeof...(Index)> makeCascadeSVFKernelTable(std::integer_sequence<int, Index...>) noexcept
+{
+    return { processSVFCascade<SampleType, Index / (2 * numCutCounts), (Index / numCutCounts) % 2, Index % numCutCounts, Interpolate>... };
+}
+
+template <typename SampleType, bool Interpolate>
+CascadeSVFKernel<SampleType> getCascadeSVFKernel(int numLowCut, int numPeak, int numHighCut) noexcept
+{
+    static constexpr auto kernels = makeCascadeSVFKernelTable<SampleType, Interpolate>(std::make_integer_sequence<int, numKernelLayouts> {});
+
+    jassert(numLowCut >= 0 && numLowCut <= maxCutStages && numPeak >= 0 && numPeak <= 1 && numHighCut >= 0 && numHighCut <= maxCutStages);
+    return kernels[(size_t) getKernelLayoutIndex(numLowCut, numPeak, numHighCut)];
+}
+
+//the extra cut sections, one slot at a time over the whole run of samples like BiquadBank::process.
+//they run after the kernel, which is fine because the order of a chain of linear filters doesn't change its output
+template <typename SampleType>
+void processCascadeSlots(CascadeRegister<SampleType>* samples, size_t numSamples, const CascadeCoefficients<SampleType>& coefficients,
+                         CascadeState<SampleType>& state, const int* slots, int numSlots) noexcept
+{
+    for (int n = 0; n < numSlots; ++n)
+    {
+        const auto slot = (size_t) slots[n];
+        const auto& c = coefficients.stages[slot];
+        auto z1 = state.s1[slot], z2 = state.s2[slot];
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            const auto y = c.b0 * x + z1;
+            z1 = c.b1 * x - c.a1 * y + z2;
+            z2 = c.b2 * x - c.a2 * y;
+            samples[i] = y;
+        }
+
+        state.s1[slot] = z1;
+        state.s2[slot] = z2;
+    }
+}
+
+//same again for the svf engine, gliding with the kernel when Interpolate is on
+template <typename SampleType, bool Interpolate>
+void processSVFSlots(CascadeRegister<SampleType>* samples, size_t numSamples,
+                     const CascadeSVFCoefficients<SampleType>& start, const CascadeSVFCoefficients<SampleType>& increment,
+                     CascadeState<SampleType>& state, size_t rampPosition, size_t rampLength, const int* slots, int numSlots) noexcept
+{
+    using Register = CascadeRegister<SampleType>;
+    const auto two = Register::expand((SampleType) 2);
+
+    for (int n = 0; n < numSlots; ++n)
+    {
+        const auto slot = (size_t) slots[n];
+        const auto& c = start.stages[slot];
+        const auto& d = increment.stages[slot];
+        auto ic1 = state.s1[slot], ic2 = state.s2[slot];
+        Register a1, a2, a3;
+
+        if constexpr (! Interpolate)
+            makeSVFIntegratorGains<SampleType>(c.g, c.k, a1, a2, a3);
+
+        for (size_t i = 0; i < numSamples; )
+        {
+            auto chunkEnd = numSamples;
+
+            if constexpr (Interpolate)
+            {
+                const auto position = rampPosition + i;
+                const auto rampChunkEnd = juce::jmin((position / svfRebuildInterval + 1) * svfRebuildInterval, rampLength);
+                chunkEnd = juce::jmin(i + rampChunkEnd - position, numSamples);
+
+                const auto steps = Register::expand((SampleType) rampChunkEnd);
+                makeSVFIntegratorGains<SampleType>(c.g + d.g * steps, c.k + d.k * steps, a1, a2, a3);
+            }
+
+            for (; i < chunkEnd; ++i)
+            {
+                auto m0 = c.m0, m1 = c.m1, m2 = c.m2;
+                if constexpr (Interpolate)
+                {
+                    const auto steps = Register::expand((SampleType) (rampPosition + i + 1));
+                    m0 += d.m0 * steps;
+                    m1 += d.m1 * steps;
+                    m2 += d.m2 * steps;
+                }
+
+                const auto x = samples[i];
+                const auto v3 = x - ic2;
+                const auto v1 = a1 * ic1 + a2 * v3;
+                const auto v2 = ic2 + a2 * ic1 + a3 * v3;
+                ic1 = two * v1 - ic1;
+                ic2 = two * v2 - ic2;
+                samples[i] = m0 * x + m1 * v1 + m2 * v2;
+            }
+        }
+
+        state.s1[slot] = ic1;
+        state.s2[slot] = ic2;
+    }
+}
+
+//everything the audio thread needs to run the cascade in one precision: the state for each group of laneCount channels,
+//the coefficients every group shares, the kernel for the current slopes and the buffer the channels get interleaved into
+template <typename SampleType>
+class FilterCascade
+{
+public:
+    using Register = CascadeRegister<SampleType>;
+    static constexpr int laneCount = (int) Register::size();
+
+    //allocates. maxBlockSize is in processing (possibly oversampled) samples.
+    //useStateVariable swaps every stage for a tpt svf, fed through setSVFStage instead of setStage.
+    //maxBankBands is how many extra bands can run after the fixed stages (they're always biquads)
+    void prepare(int numChannels, int maxBlockSize, bool useStateVariable = false, int maxBankBands = 0)
+    {
+        stateVariable = useStateVariable;
+        //the first svf designs after this get used as they are, there's nothing sensible to glide from
+        svfSnapToTargets = true;
+        svfTargetsChanged = false;
+        svfRampPosition = svfRampLength = svfNextRampLength = 0;
+        //slots that haven't been designed yet pass straight through, so a stage that gets switched on later glides in from nothing
+        svfTargets.stages.fill(broadcastSVF<SampleType>(makeSVF(0.0, 0.0, 1.0, 0.0, 0.0)));
+
+        const auto numGroups = getNumGroups(numChannels);
+        statePool.resize(numGroups);
+        bank.prepare(maxBankBands, numGroups);
+        reset();
+
+        //lanes we don't use stay zero, so they never produce anything
+        interleaved = juce::dsp::AudioBlock<Register>(interleavedData, numGroups, (size_t) maxBlockSize);
+        interleaved.clear();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& state : statePool)
+            state.reset();
+        bank.reset();
+    }
+
+    static size_t getNumGroups(int numChannels) noexcept { return (size_t) ((numChannels + laneCount - 1) / laneCount); }
+    size_t getMaxBlockSize() const noexcept { return interleaved.getNumSamples(); }
+
+    bool isStateVariable() const noexcept { return stateVariable; }
+
+    void setStage(int slot, const BiquadArray& biquad) noexcept { coefficients.stages[(size_t) slot] = broadcastBiquad<SampleType>(biquad); }
+
+    //just one lane's coefficients, for mid / side where the two lanes run different filters.
+    //every group shares the coefficients, so this only makes sense with a single group
+    void setStage(int slot, const BiquadArray& biquad, int lane) noexcept
+    {
+        auto& stage = coefficients.stages[(size_t) slot];
+        const auto l = (size_t) lane;
+        stage.b0.set(l, (SampleType) biquad[0]);
+        stage.b1.set(l, (SampleType) biquad[1]);
+        stage.b2.set(l, (SampleType) biquad[2]);
+        stage.a1.set(l, (SampleType) biquad[3]);
+        stage.a2.set(l, (SampleType) biquad[4]);
+    }
+
+    //how many samples the svf takes to glide to the targets set before the next process call, however many calls that
+    //takes. without one it glides over that next call alone
+    void setSVFRampLength(int numSamples) noexcept { svfNextRampLength = numSamples; }
+
+    //the svf glides to these instead of jumping, see setSVFRampLength
+    void setSVFStage(int slot, const SVFArray& svf) noexcept
+    {
+        svfTargets.stages[(size_t) slot] = broadcastSVF<SampleType>(svf);
+        svfTargetsChanged = true;
+    }
+
+    void setSVFStage(int slot, const SVFArray& svf, int lane) noexcept
+    {
+        auto& stage = svfTargets.stages[(size_t) slot];
+        const auto l = (size_t) lane;
+        stage.g.set(l, (SampleType) svf[0]);
+        stage.k.set(l, (SampleType) svf[1]);
+        stage.m0.set(l, (SampleType) svf[2]);
+        stage.m1.set(l, (SampleType) svf[3]);
+        stage.m2.set(l, (SampleType) svf[4]);
+        svfTargetsChanged = true;
+    }
+
+    //picks the kernel built for exactly this many stages per band (0 for a band that's been elided).
+    //cuts can have up to maxCutSections, the kernel takes the first maxCutStages and the rest go on the extra slot list
+    void setStageCounts(int numLowCut, int numPeak, int numHighCut) noexcept
+    {
+        jassert(numLowCut >= 0 && numLowCut <= maxCutSections && numHighCut >= 0 && numHighCut <= maxCutSections);
+        const auto fusedLowCut = juce::jmin(numLowCut, maxCutStages), fusedHighCut = juce::jmin(numHighCut, maxCutStages);
+
+        kernel = getCascadeKernel<SampleType>(fusedLowCut, numPeak, fusedHighCut);
+        svfKernel = getCascadeSVFKernel<SampleType, false>(fusedLowCut, numPeak, fusedHighCut);
+        svfRampKernel = getCascadeSVFKernel<SampleType, true>(fusedLowCut, numPeak, fusedHighCut);
+
+        numExtraSlots = 0;
+        for (int section = maxCutStages; section < numLowCut; ++section)
+            extraSlots[(size_t) numExtraSlots++] = getLowCutSlot(section);
+        for (int section = maxCutStages; section < numHighCut; ++section)
+            extraSlots[(size_t) numExtraSlots++] = getHighCutSlot(section);
+
+        numActiveStages = numLowCut + numPeak + numHighCut;
+    }
+
+    //nothing in the path at all, the caller can skip interleaving
+    bool isEmpty() const noexcept { return numActiveStages == 0 && bank.getNumActiveBands() == 0; }
+
+    //the extra bands, by band index. setting one that isn't running yet adds it, removing one packs the rest together
+    void setBankBand(int band, const BiquadArray& biquad) noexcept { bank.setBand(band, biquad); }
+    void removeBankBand(int band) noexcept { bank.removeBand(band); }
+    int getNumBankBands() const noexcept { return bank.getNumActiveBands(); }
+
+    //a band coming back into the path starts from silence rather than whatever it held when it left
+    void resetStages(int firstSlot, int numSlots) noexcept
+    {
+        const auto zero = Register::expand(0);
+        for (auto& state : statePool)
+        {
+            for (int slot = firstSlot; slot < firstSlot + numSlots; ++slot)
+            {
+                state.s1[(size_t) slot] = zero;
+                state.s2[(size_t) slot] = zero;
+            }
+        }
+    }
+
+    //gives toChannel exactly the state fromChannel has, for when channels that were being filtered as one split up again
+    void copyChannelState(int fromChannel, int toChannel) noexcept
+    {
+        const auto& from = statePool[(size_t) (fromChannel / laneCount)];
+        auto& to = statePool[(size_t) (toChannel / laneCount)];
+        const auto fromLane = (size_t) (fromChannel % laneCount), toLane = (size_t) (toChannel % laneCount);
+
+        for (size_t slot = 0; slot < from.s1.size(); ++slot)
+        {
+            to.s1[slot].set(toLane, from.s1[slot].get(fromLane));
+            to.s2[slot].set(toLane, from.s2[slot].get(fromLane));
+        }
+
+        bank.copyChannelState(fromChannel, toChannel);
+    }
+
+    //channel c goes into lane (c % laneCount) of group (c / laneCount), one register per sample
+    void interleave(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int numSamples) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* samples = block.getChannelPointer((size_t) channel);
+            auto* lanes = reinterpret_cast<SampleType*>(interleaved.getChannelPointer((size_t) channel / laneCount)) + channel % laneCount;
+            for (int i = 0; i < numSamples; ++i)
+                lanes[(size_t) i * laneCount] = samples[i];
+        }
+    }
+
+    void deinterleave(const juce::dsp::AudioBlock<SampleType>& block, int numChannels, int numSamples) const noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* samples = block.getChannelPointer((size_t) channel);
+            const auto* lanes = reinterpret_cast<const SampleType*>(interleaved.getChannelPointer((size_t) channel / laneCount)) + channel % laneCount;
+            for (int i = 0; i < numSamples; ++i)
+                samples[i] = lanes[(size_t) i * laneCount];
+        }
+    }
+
+    //mid / side: left and right go into lanes 0 and 1 as (l + r) / 2 and (l - r) / 2 and come back out as m + s and m - s.
+    //the matrix rides along on the pass interleaving makes over the samples anyway, so it costs no extra trip through memory
+    void interleaveMidSide(const juce::dsp::AudioBlock<SampleType>& block, int numSamples) noexcept
+    {
+        static_assert(laneCount >= 2, "mid / side needs two lanes in one register");
+        const auto* left = block.getChannelPointer(0);
+        const auto* right = block.getChannelPointer(1);
+        auto* lanes = reinterpret_cast<SampleType*>(interleaved.getChannelPointer(0));
+        const auto half = (SampleType) 0.5;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            lanes[(size_t) i * laneCount] = (left[i] + right[i]) * half;
+            lanes[(size_t) i * laneCount + 1] = (left[i] - right[i]) * half;
+        }
+    }
+
+    void deinterleaveMidSide(const juce::dsp::AudioBlock<SampleType>& block, int numSamples) const noexcept
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+        const auto* lanes = reinterpret_cast<const SampleType*>(interleaved.getChannelPointer(0));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto mid = lanes[(size_t) i * laneCount], side = lanes[(size_t) i * laneCount + 1];
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    //one pass through all the filters takes care of a whole group of channels
+    void process(int startSample, int numSamples, size_t numGroups) noexcept
+    {
+        if (stateVariable)
+        {
+            processStateVariable(startSample, numSamples, numGroups);
+            return;
+        }
+
+        //the bank runs on each group straight after the fixed stages, while its samples are still in cache
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            auto* samples = interleaved.getChannelPointer(group) + startSample;
+            kernel(samples, (size_t) numSamples, coefficients, statePool[group]);
+            processCascadeSlots(samples, (size_t) numSamples, coefficients, statePool[group], extraSlots.data(), numExtraSlots);
+            bank.process(samples, (size_t) numSamples, group);
+        }
+    }
+
+private:
+    void processStateVariable(int startSample, int numSamples, size_t numGroups) noexcept
+    {
+        if (svfSnapToTargets)
+        {
+            svfCoefficients = svfTargets;
+            svfSnapToTargets = svfTargetsChanged = false;
+            svfRampPosition = svfRampLength = 0;
+        }
+
+        if (numSamples <= 0)
+            return;
+
+        const auto nextRampLength = svfNextRampLength;
+        svfNextRampLength = 0;
+
+        //new targets: a straight line in g, k and the mix gains from wherever every stage has got to, landing exactly on the
+        //ramp's last sample. the line is kept across calls, so where the host splits its blocks doesn't change it.
+        //every slot gets one, an extra slot that starts running halfway through the ramp needs its line too
+        if (svfTargetsChanged)
+        {
+            if (svfRampPosition < svfRampLength)
+            {
+                const auto steps = Register::expand((SampleType) svfRampPosition);
+                for (size_t slot = 0; slot < (size_t) maxCascadeStages; ++slot)
+                {
+                    const auto& from = svfRampStart.stages[slot];
+                    const auto& d = svfIncrements.stages[slot];
+                    svfCoefficients.stages[slot] = { from.g + d.g * steps, from.k + d.k * steps,
+                                                     from.m0 + d.m0 * steps, from.m1 + d.m1 * steps, from.m2 + d.m2 * steps };
+                }
+            }
+
+            svfRampStart = svfCoefficients;
+            svfRampLength = nextRampLength > 0 ? nextRampLength : numSamples;
+            svfRampPosition = 0;
+            svfTargetsChanged = false;
+
+            const auto scale = Register::expand((SampleType) 1 / (SampleType) svfRampLength);
+            for (size_t slot = 0; slot < (size_t) maxCascadeStages; ++slot)
+            {
+                const auto& from = svfRampStart.stages[slot];
+                const auto& to = svfTargets.stages[slot];
+                svfIncrements.stages[slot] = { (to.g - from.g) * scale, (to.k - from.k) * scale,
+                                               (to.m0 - from.m0) * scale, (to.m1 - from.m1) * scale, (to.m2 - from.m2) * scale };
+            }
+        }
+
+        //whatever's left of the ramp, then the targets as they are. nothing moving means no per sample adds at all
+        const auto numRamping = juce::jmin(numSamples, svfRampLength - svfRampPosition);
+        const auto numSteady = numSamples - numRamping;
+
+        for (size_t group = 0; group < numGroups; ++group)
+        {
+            auto* samples = interleaved.getChannelPointer(group) + startSample;
+
+            if (numRamping > 0)
+            {
+                svfRampKernel(samples, (size_t) numRamping, svfRampStart, svfIncrements, statePool[group],
+                              (size_t) svfRampPosition, (size_t) svfRampLength);
+                processSVFSlots<SampleType, true>(samples, (size_t) numRamping, svfRampStart, svfIncrements, statePool[group],
+                                                  (size_t) svfRampPosition, (size_t) svfRampLength, extraSlots.data(), numExtraSlots);
+            }
+
+            if (numSteady > 0)
+            {
+                svfKernel(samples + numRamping, (size_t) numSteady, svfTargets, svfIncrements, statePool[group], 0, 0);
+                processSVFSlots<SampleType, false>(samples + numRamping, (size_t) numSteady, svfTargets, svfIncrements, statePool[group],
+                                                   0, 0, extraSlots.data(), numExtraSlots);
+            }
+
+            bank.process(samples, (size_t) numSamples, group);
+        }
+
+        svfRampPosition += numRamping;
+        if (numRamping > 0 && svfRampPosition == svfRampLength)
+            svfCoefficients = svfTargets;
+    }
+
+    std::vector<CascadeState<SampleType>> statePool;
+    CascadeCoefficients<SampleType> coefficients;
+    CascadeKernel<SampleType> kernel { getCascadeKernel<SampleType>(1, 1, 1) };
+    int numActiveStages { 3 };
+
+    //the cut sections past maxCutStages that are running, in the order they run. never more than every extra slot
+    std::array<int, 2 * numExtraCutSections> extraSlots {};
+    int numExtraSlots { 0 };
+
+    //the svf engine: where every stage was when nothing was ramping (or the last ramp got retargeted), where it's heading,
+    //and the current ramp: where it started, the per sample step and how far along it we are
+    bool stateVariable { false }, svfSnapToTargets { true }, svfTargetsChanged { false };
+    CascadeSVFCoefficients<SampleType> svfCoefficients, svfTargets, svfRampStart, svfIncrements;
+    int svfRampPosition { 0 }, svfRampLength { 0 }, svfNextRampLength { 0 };
+    CascadeSVFKernel<SampleType> svfKernel { getCascadeSVFKernel<SampleType, false>(1, 1, 1) };
+    CascadeSVFKernel<SampleType> svfRampKernel { getCascadeSVFKernel<SampleType, true>(1, 1, 1) };
+
+    //the extra bands, biquads whichever engine runs the fixed stages
+    BiquadBank<SampleType> bank;
+
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<Register> interleaved;
+};
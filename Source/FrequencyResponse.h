@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    FrequencyResponse.h
+    magnitude (and phase) of a whole cascade of biquads over a fixed log frequency grid,
+    worked out a SIMDRegister of points at a time
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+class FrequencyResponse
+{
+public:
+    using DoubleRegister = juce::dsp::SIMDRegister<double>;
+
+    //numPoints log spaced frequencies from minFrequency to maxFrequency (both ends included).
+    //the e^-jw terms for every point get worked out here, so evaluate never touches trig
+    void prepare(int numPointsToUse, double minFrequency, double maxFrequency, double sampleRateToUse)
+    {
+        jassert(numPointsToUse >= 2 && minFrequency > 0 && maxFrequency > minFrequency);
+
+        std::vector<double> logFrequencies((size_t) numPointsToUse);
+        for (int i = 0; i < numPointsToUse; ++i)
+            logFrequencies[(size_t) i] = juce::mapToLog10((double) i / (double) (numPointsToUse - 1), minFrequency, maxFrequency);
+
+        prepare(logFrequencies, sampleRateToUse);
+        range = { minFrequency, maxFrequency };
+    }
+
+    //any other set of frequencies, eg the bins of an fft
+    void prepare(const std::vector<double>& frequenciesToUse, double sampleRateToUse)
+    {
+        jassert(! frequenciesToUse.empty() && sampleRateToUse > 0);
+
+        frequencies = frequenciesToUse;
+        numPoints = (int) frequencies.size();
+        range = {};
+        sampleRate = sampleRateToUse;
+
+        const auto numRegisters = (numPoints + (int) laneCount - 1) / (int) laneCount;
+        cos1.assign((size_t) numRegisters, DoubleRegister::expand(1.0));
+        sin1.assign((size_t) numRegisters, DoubleRegister::expand(0.0));
+        cos2.assign((size_t) numRegisters, DoubleRegister::expand(1.0));
+        sin2.assign((size_t) numRegisters, DoubleRegister::expand(0.0));
+        numeratorReal.resize((size_t) numRegisters);
+        numeratorImag.resize((size_t) numRegisters);
+        denominatorReal.resize((size_t) numRegisters);
+        denominatorImag.resize((size_t) numRegisters);
+
+        //the padding lanes at the end just sit at w = 0
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto w = juce::MathConstants<double>::twoPi * frequencies[(size_t) i] / sampleRate;
+            const auto r = (size_t) i / laneCount, lane = (size_t) i % laneCount;
+            cos1[r].set(lane, std::cos(w));
+            sin1[r].set(lane, std::sin(w));
+            cos2[r].set(lane, std::cos(2.0 * w));
+            sin2[r].set(lane, std::sin(2.0 * w));
+        }
+    }
+
+    bool matches(int numPointsToCheck, double minFrequency, double maxFrequency, double sampleRateToCheck) const noexcept
+    {
+        return numPoints == numPointsToCheck && range.getStart() == minFrequency
+            && range.getEnd() == maxFrequency && sampleRate == sampleRateToCheck;
+    }
+
+    int getNumPoints() const noexcept { return numPoints; }
+    double getFrequency(int index) const noexcept { return frequencies[(size_t) index]; }
+
+    //combined response of numBiquads cascaded biquads. decibels gets getNumPoints() values,
+    //phaseRadians too (wrapped to -pi..pi) if it isn't null. doesn't allocate
+    void evaluate(const BiquadArray* biquads, int numBiquads, float* decibels, float* phaseRadians = nullptr) noexcept
+    {
+        jassert(numPoints > 0);
+
+        const auto withPhase = phaseRadians != nullptr;
+        const auto numRegisters = cos1.size();
+        const auto one = DoubleRegister::expand(1.0), zero = DoubleRegister::expand(0.0);
+
+        std::fill(numeratorReal.begin(), numeratorReal.end(), one);
+        std::fill(numeratorImag.begin(), numeratorImag.end(), zero);
+        std::fill(denominatorReal.begin(), denominatorReal.end(), one);
+        std::fill(denominatorImag.begin(), denominatorImag.end(), zero);
+
+        //one biquad at a time across every point, so its coefficients only get broadcast once
+        for (int b = 0; b < numBiquads; ++b)
+        {
+            const auto& biquad = biquads[b];
+            const auto b0 = DoubleRegister::expand(biquad[0]), b1 = DoubleRegister::expand(biquad[1]), b2 = DoubleRegister::expand(biquad[2]);
+            const auto a1 = DoubleRegister::expand(biquad[3]), a2 = DoubleRegister::expand(biquad[4]);
+
+            for (size_t r = 0; r < numRegisters; ++r)
+            {
+                //b0 + b1 e^-jw + b2 e^-2jw over 1 + a1 e^-jw + a2 e^-2jw
+                const auto nRe = b0 + b1 * cos1[r] + b2 * cos2[r];
+                const auto nIm = zero - (b1 * sin1[r] + b2 * sin2[r]);
+                const auto dRe = one + a1 * cos1[r] + a2 * cos2[r];
+                const auto dIm = zero - (a1 * sin1[r] + a2 * sin2[r]);
+
+                if (withPhase)
+                {
+                    //keep the full complex products so the phase comes out at the end
+                    multiplyComplex(numeratorReal[r], numeratorImag[r], nRe, nIm);
+                    multiplyComplex(denominatorReal[r], denominatorImag[r], dRe, dIm);
+                }
+                else
+                {
+                    //magnitude only needs |N|^2 and |D|^2, kept in the real parts
+                    numeratorReal[r] = numeratorReal[r] * (nRe * nRe + nIm * nIm);
+                    denominatorReal[r] = denominatorReal[r] * (dRe * dRe + dIm * dIm);
+                }
+            }
+        }
+
+        //one log (and atan2) per point at the end instead of per biquad
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto r = (size_t) i / laneCount, lane = (size_t) i % laneCount;
+            const auto nRe = numeratorReal[r][lane], nIm = numeratorImag[r][lane];
+            const auto dRe = denominatorReal[r][lane], dIm = denominatorImag[r][lane];
+
+            const auto numeratorSquared = withPhase ? nRe * nRe + nIm * nIm : nRe;
+            const auto denominatorSquared = withPhase ? dRe * dRe + dIm * dIm : dRe;
+            //10 log10 of the squared ratio is 20 log10 of the magnitude. floored at the same -100db gainToDecibels uses
+            decibels[i] = (float) juce::jmax(-100.0, 10.0 * std::log10(numeratorSquared / denominatorSquared));
+
+            if (withPhase)
+                phaseRadians[i] = (float) std::remainder(std::atan2(nIm, nRe) - std::atan2(dIm, dRe), juce::MathConstants<double>::twoPi);
+        }
+    }
+
+    //linear interpolation from a coarse grid onto a finer one over the same log frequency range,
+    //for when one point per physical pixel would be wasted on a curve this smooth
+    static void resample(const float* source, int numSource, float* destination, int numDestination) noexcept
+    {
+        jassert(numSource >= 2 && numDestination >= 2);
+
+        for (int i = 0; i < numDestination; ++i)
+        {
+            const auto position = (double) i * (numSource - 1) / (numDestination - 1);
+            const auto index = juce::jmin((int) position, numSource - 2);
+            const auto fraction = (float) (position - index);
+            destination[i] = source[index] + fraction * (source[index + 1] - source[index]);
+        }
+    }
+
+private:
+    static constexpr size_t laneCount = DoubleRegister::size();
+
+    static void multiplyComplex(DoubleRegister& re, DoubleRegister& im, DoubleRegister otherRe, DoubleRegister otherIm) noexcept
+    {
+        const auto newRe = re * otherRe - im * otherIm;
+        im = re * otherIm + im * otherRe;
+        re = newRe;
+    }
+
+    int numPoints { 0 };
+    juce::Range<double> range;
+    double sampleRate { 0 };
+    std::vector<double> frequencies;
+    //e^-jw and e^-2jw for every point, laneCount points per register
+    std::vector<DoubleRegister> cos1, sin1, cos2, sin2;
+    //running products while evaluating
+    std::vector<DoubleRegister> numeratorReal, numeratorImag, denominatorReal, denominatorImag;
+};
@@ -0,0 +1,248 @@
+/*
+  ==============================================================================
+
+    LinearPhaseConvolver.h
+    uniformly partitioned overlap-save fft convolution for the linear phase mode.
+    kernels get partitioned and transformed off the audio thread, the audio thread
+    only runs the frequency domain multiply-adds and crossfades when a new kernel lands
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class LinearPhaseConvolver
+{
+public:
+    //allocates everything. partitionSize is half the fft size, kernelLength a multiple of it
+    void prepare(int numChannelsToUse, int partitionSizeToUse, int kernelLengthToUse)
+    {
+        jassert(juce::isPowerOfTwo(partitionSizeToUse) && kernelLengthToUse % partitionSizeToUse == 0);
+
+        numChannels = numChannelsToUse;
+        partitionSize = partitionSizeToUse;
+        kernelLength = kernelLengthToUse;
+        numPartitions = kernelLength / partitionSize;
+        //non negative bins of a 2 * partitionSize real fft, interleaved re/im
+        spectrumSize = (partitionSize + 1) * 2;
+
+        const auto order = juce::roundToInt(std::log2(partitionSize * 2));
+        audioFft = std::make_unique<juce::dsp::FFT>(order);
+        designFft = std::make_unique<juce::dsp::FFT>(order);
+
+        for (auto& kernel : kernels)
+            kernel.assign((size_t) (numPartitions * spectrumSize), 0.f);
+
+        channels.resize((size_t) numChannels);
+        for (auto& channel : channels)
+        {
+            channel.input.assign((size_t) partitionSize * 2, 0.f);
+            channel.output.assign((size_t) partitionSize, 0.f);
+            channel.delayLine.assign((size_t) (numPartitions * spectrumSize), 0.f);
+        }
+
+        //juce's real fft wants room for the full complex result
+        fftBuffer.assign((size_t) partitionSize * 4, 0.f);
+        fadeBuffer.assign((size_t) partitionSize * 4, 0.f);
+        designBuffer.assign((size_t) partitionSize * 4, 0.f);
+        accumulator.assign((size_t) spectrumSize, 0.f);
+
+        activeKernel = 0;
+        fadingFromKernel = -1;
+        spareSlotState.store(SlotFree);
+        hasKernel = false;
+        bufferPosition = 0;
+        delayLinePosition = 0;
+    }
+
+    //one partition of buffering plus half the (symmetric) kernel
+    int getLatencySamples() const noexcept { return partitionSize + kernelLength / 2; }
+    int getKernelLength() const noexcept { return kernelLength; }
+
+    //designer side (one thread at a time): false until the audio thread has taken the last kernel and faded away from the one before
+    bool isReadyForKernel() const noexcept { return spareSlotState.load() == SlotFree; }
+
+    //designer side: partitions and transforms kernelLength taps into the spare slot and hands it to the audio thread
+    void setKernel(const float* impulseResponse) noexcept
+    {
+        auto expected = (int) SlotFree;
+        if (! spareSlotState.compare_exchange_strong(expected, SlotWriting))
+        {
+            jassertfalse;
+            return;
+        }
+
+        //the audio thread only swaps slots once we've said Pending, so this stays the spare one while we write
+        const auto slot = 1 - activeKernel.load();
+        auto& kernel = kernels[(size_t) slot];
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            //each partition zero padded to the fft size
+            std::fill(designBuffer.begin(), designBuffer.end(), 0.f);
+            std::copy_n(impulseResponse + p * partitionSize, partitionSize, designBuffer.begin());
+            designFft->performRealOnlyForwardTransform(designBuffer.data(), true);
+            std::copy_n(designBuffer.begin(), spectrumSize, kernel.begin() + p * spectrumSize);
+        }
+
+        spareSlotState.store(SlotPending);
+    }
+
+    //audio thread: filters the block in place, channels past the prepared count are left alone.
+    //the kernel and the convolution are float either way, double blocks just get converted on the way in and out
+    template <typename SampleType>
+    void process(juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = (int) block.getNumSamples();
+        const auto numToProcess = juce::jmin((int) block.getNumChannels(), numChannels);
+
+        for (int start = 0; start < numSamples; )
+        {
+            const auto num = juce::jmin(partitionSize - bufferPosition, numSamples - start);
+
+            for (int ch = 0; ch < numToProcess; ++ch)
+            {
+                auto* samples = block.getChannelPointer((size_t) ch) + start;
+                auto& channel = channels[(size_t) ch];
+                std::copy_n(samples, num, channel.input.begin() + partitionSize + bufferPosition);
+                std::copy_n(channel.output.begin() + bufferPosition, num, samples);
+            }
+
+            bufferPosition += num;
+            start += num;
+
+            if (bufferPosition == partitionSize)
+            {
+                processPartition(numToProcess);
+                bufferPosition = 0;
+            }
+        }
+    }
+
+    //same as FilterCascade::copyChannelState. the sizes match, so this never allocates
+    void copyChannelState(int fromChannel, int toChannel) noexcept
+    {
+        channels[(size_t) toChannel] = channels[(size_t) fromChannel];
+    }
+
+    void reset() noexcept
+    {
+        for (auto& channel : channels)
+        {
+            std::fill(channel.input.begin(), channel.input.end(), 0.f);
+            std::fill(channel.output.begin(), channel.output.end(), 0.f);
+            std::fill(channel.delayLine.begin(), channel.delayLine.end(), 0.f);
+        }
+
+        bufferPosition = 0;
+    }
+
+private:
+    struct Channel {
+        //last two partitions of input, the current partition of output and the spectra of the last numPartitions inputs
+        std::vector<float> input, output, delayLine;
+    };
+
+    void processPartition(int numToProcess) noexcept
+    {
+        //pick up a new kernel at a partition boundary, the old one stays valid until this partition is faded over.
+        //with nothing to fade from, the old slot can go straight back to the designer
+        if (spareSlotState.load() == SlotPending)
+        {
+            fadingFromKernel = hasKernel ? activeKernel.load() : -1;
+            activeKernel.store(1 - activeKernel.load());
+            hasKernel = true;
+            spareSlotState.store(fadingFromKernel >= 0 ? SlotFading : SlotFree);
+        }
+
+        for (int ch = 0; ch < numToProcess; ++ch)
+        {
+            auto& channel = channels[(size_t) ch];
+
+            //overlap-save: the last two partitions of input, transformed into this partition's slot in the delay line
+            std::copy(channel.input.begin(), channel.input.end(), fftBuffer.begin());
+            std::fill(fftBuffer.begin() + partitionSize * 2, fftBuffer.end(), 0.f);
+            audioFft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+            std::copy_n(fftBuffer.begin(), spectrumSize, channel.delayLine.begin() + delayLinePosition * spectrumSize);
+            std::copy(channel.input.begin() + partitionSize, channel.input.end(), channel.input.begin());
+
+            convolve(channel, kernels[(size_t) activeKernel.load()], fftBuffer);
+
+            if (fadingFromKernel >= 0)
+            {
+                //one partition of crossfade from the old kernel's output to the new one's
+                convolve(channel, kernels[(size_t) fadingFromKernel], fadeBuffer);
+                for (int i = 0; i < partitionSize; ++i)
+                {
+                    const auto t = (float) (i + 1) / (float) partitionSize;
+                    channel.output[(size_t) i] = fadeBuffer[(size_t) (partitionSize + i)] + t * (fftBuffer[(size_t) (partitionSize + i)] - fadeBuffer[(size_t) (partitionSize + i)]);
+                }
+            }
+            else
+            {
+                std::copy_n(fftBuffer.begin() + partitionSize, partitionSize, channel.output.begin());
+            }
+        }
+
+        delayLinePosition = (delayLinePosition + 1) % numPartitions;
+
+        //the old slot is free for the next design once it's been faded out
+        if (fadingFromKernel >= 0)
+        {
+            fadingFromKernel = -1;
+            spareSlotState.store(SlotFree);
+        }
+    }
+
+    //sums every partition of the kernel against the matching input spectrum and transforms back into result.
+    //the second half of result is the valid output (the first half is the circular wrap overlap-save throws away)
+    void convolve(const Channel& channel, const std::vector<float>& kernel, std::vector<float>& result) noexcept
+    {
+        std::fill(accumulator.begin(), accumulator.end(), 0.f);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            const auto slot = (delayLinePosition - p + numPartitions) % numPartitions;
+            const auto* x = channel.delayLine.data() + slot * spectrumSize;
+            const auto* h = kernel.data() + p * spectrumSize;
+            auto* y = accumulator.data();
+
+            for (int bin = 0; bin < spectrumSize; bin += 2)
+            {
+                y[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+                y[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+            }
+        }
+
+        std::copy(accumulator.begin(), accumulator.end(), result.begin());
+        std::fill(result.begin() + spectrumSize, result.end(), 0.f);
+        audioFft->performRealOnlyInverseTransform(result.data());
+    }
+
+    int numChannels { 0 }, partitionSize { 0 }, kernelLength { 0 }, numPartitions { 0 }, spectrumSize { 0 };
+    std::unique_ptr<juce::dsp::FFT> audioFft, designFft;
+
+    //two kernel slots: the one the audio thread is using, and a spare the designer fills.
+    //the spare goes Free -> Writing -> Pending on the designer's side, then Pending -> Fading -> Free on the audio thread's,
+    //so neither side ever touches it while the other one might be
+    enum SpareSlotState {
+        SlotFree,
+        SlotWriting,
+        SlotPending,
+        SlotFading
+    };
+
+    std::array<std::vector<float>, 2> kernels;
+    std::atomic<int> activeKernel { 0 }, spareSlotState { SlotFree };
+
+    //audio thread only
+    std::vector<Channel> channels;
+    std::vector<float> fftBuffer, fadeBuffer, accumulator;
+    int fadingFromKernel { -1 }, bufferPosition { 0 }, delayLinePosition { 0 };
+    bool hasKernel { false };
+
+    //designer only
+    std::vector<float> designBuffer;
+};
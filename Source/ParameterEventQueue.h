@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.h
+    lock free queue of timestamped parameter changes, one producer thread and the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct ParameterEvent {
+    //on the processor's own sample clock (samples since prepareToPlay)
+    juce::int64 samplePosition { 0 };
+    //a ChainParameter
+    int parameter { 0 };
+    float value { 0 };
+};
+
+class ParameterEventQueue
+{
+public:
+    explicit ParameterEventQueue(int capacity = 1024) : fifo(capacity), events((size_t) capacity) {}
+
+    //producer side. events have to be pushed in time order. returns false (and drops the event) when full
+    bool push(const ParameterEvent& event) noexcept
+    {
+        auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        events[(size_t) scope.startIndex1] = event;
+        return true;
+    }
+
+    //audio thread side: true if popIfBefore would hand something out, without taking it
+    bool hasEventBefore(juce::int64 endPosition) const noexcept
+    {
+        if (fifo.getNumReady() == 0)
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+
+        //later events wait in the queue for the block they belong to
+        return size1 > 0 && events[(size_t) start1].samplePosition < endPosition;
+    }
+
+    //audio thread side: hands out the oldest event, but only if it lands before the given position
+    bool popIfBefore(juce::int64 endPosition, ParameterEvent& event) noexcept
+    {
+        if (! hasEventBefore(endPosition))
+            return false;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+
+        event = events[(size_t) start1];
+        fifo.finishedRead(1);
+        return true;
+    }
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<ParameterEvent> events;
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterEventQueue)
+};
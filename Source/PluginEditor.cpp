@@ -22,6 +22,9 @@ ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) : audi
         param->addListener(this);
     }
     
+    //only run the analyzer while someone can see it
+    audioProcessor.getAnalyzer().setEnabled(true);
+    
     //start with a 60hz refresh rate
     startTimerHz(60);
 }
@@ -35,7 +38,12 @@ ResponseCurveComponent::~ResponseCurveComponent()
     {
         param->removeListener(this);
     }
-
+    
+    audioProcessor.getAnalyzer().setEnabled(false);
+    
+    //make sure the curve job isn't still running before we go
+    stopTimer();
+    curveThread.removeAllJobs(true, 1000);
 }
 
 //migrate parameterValue changed callback
@@ -44,98 +52,32 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
     parametersChanged.set(true);
 }
 
-//set up timer callback
-void ResponseCurveComponent::timerCallback()
+namespace
 {
-    //see if it is true, if it is we want to set it back to false
-    if (parametersChanged.compareAndSetBool(false, true))
-    {
-        //update monochain
-        //grab chain settings
-        auto chainSettings = getChainSettings(audioProcessor.apvts);
-        //make coefficients for peak band
-        auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-        //update our old (peak from monochain) coefficients with new replacements (peakCoefficients)
-        updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-        
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings,audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-        // chain is the monochain. replace with low cut coefficients, and low cut slope
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
-        
-        
-        //trigger a repaint
-        repaint();
-    };
-}
-
-void ResponseCurveComponent::paint (juce::Graphics& g)
+//designs the chain and builds the curve for it. only touches the workspace it's given, so it can run on any thread
+juce::Path makeResponseCurve(const ChainSettings& chainSettings, const BankSettings& bankSettings, double sampleRate, juce::Rectangle<int> responseArea,
+                             FrequencyResponse& response, std::vector<float>& coarse, std::vector<float>& decibels)
 {
-    //so we don't have to keep typing juce::..
     using namespace juce;
     
-    // PREVIOUS CODE
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    // g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-    // g.setColour (juce::Colours::white);
-    // g.setFont (juce::FontOptions (15.0f));
-    // g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+    const auto w = responseArea.getWidth();
     
-    g.fillAll (Colours::black);
-    // need response area
-    auto responseArea = getLocalBounds();
-    // and width
-    auto w = responseArea.getWidth();
-    
-    // need chain elements
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    
-    //call get magnitude for frequency function for each element in the chain
-    auto sampleRate = audioProcessor.getSampleRate();
-    // need a place to store all the magnitudes (doubles)
-    std::vector<double> mags;
-    // 1 magnitude per pixel so create space we need
-    mags.resize(w);
-    // iterate thorugh each pixel and compute magnitude at that frequency
-    for (int i = 0; i < w; ++i )
+    //the curve is smooth at this scale, so work out every other pixel and interpolate the rest
+    const auto numPoints = jmax(2, (w + 1) / 2);
+    if (! response.matches(numPoints, 20.0, 20000.0, sampleRate))
     {
-        // magnitude expressed as gain units (multiplicatibe) so start with 1
-        double mag = 1.f;
-        // call magnitude function for a particular pixed mapped from pixel space to frequency space
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-        
-        // check if a band is bypassed, if it is then we won't do this function
-        if (! monoChain.isBypassed<ChainPositions::Peak>())
-            mag *= peak.coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        // do the same thing for every other fiklter in the low and highcut chains
-        
-        //lowcut is defined as its own processor chain, so we need to get each individual element of it
-        if (! lowcut.isBypassed<0>())
-            mag *= lowcut.get<0>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! lowcut.isBypassed<1>())
-            mag *= lowcut.get<1>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! lowcut.isBypassed<2>())
-            mag *= lowcut.get<2>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! lowcut.isBypassed<3>())
-            mag *= lowcut.get<3>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        
-        if (! highcut.isBypassed<0>())
-            mag *= highcut.get<0>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! highcut.isBypassed<1>())
-            mag *= highcut.get<1>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! highcut.isBypassed<2>())
-            mag *= highcut.get<2>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        if (! highcut.isBypassed<3>())
-            mag *= highcut.get<3>().coefficients-> getMagnitudeForFrequency(freq, sampleRate);
-        
-        //convert magnitude into decibels and store it
-        mags[i] = Decibels::gainToDecibels(mag);
+        response.prepare(numPoints, 20.0, 20000.0, sampleRate);
+        coarse.resize((size_t) numPoints);
     }
-    //build path from the vecot of decibels
-    Path responseCurve;
+    decibels.resize((size_t) jmax(2, w));
+    
+    //the fixed bands and then whichever extra bands are switched on
+    std::array<BiquadArray, maxResponseBiquads> biquads;
+    auto numBiquads = getActiveBiquads(makeChainCoefficients(chainSettings, sampleRate), biquads);
+    numBiquads += getActiveBankBiquads(makeBankCoefficients(bankSettings, sampleRate), biquads.data() + numBiquads);
+    response.evaluate(biquads.data(), numBiquads, coarse.data());
+    FrequencyResponse::resample(coarse.data(), numPoints, decibels.data(), (int) decibels.size());
+    
     // map decibel value to response area
     // define max and minimum positions in the window
     const double outputMin = responseArea.getBottom();
@@ -146,27 +88,208 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
     
-    //left edge of the component, first value will be map(mags.front())
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    //left edge of the component, first value will be map(decibels.front())
+    Path responseCurve;
+    responseCurve.startNewSubPath(responseArea.getX(), map(decibels.front()));
     
     // create line
-    for ( size_t i = 1; i < mags.size(); ++i )
+    for (int i = 1; i < w; ++i)
+        responseCurve.lineTo(responseArea.getX() + i, map(decibels[(size_t) i]));
+    
+    return responseCurve;
+}
+
+//one point every couple of pixels. where several bins squeeze into one point we keep the loudest, where bins are
+//further apart than that (the low end) we interpolate between them
+juce::Path makeSpectrumPath(const std::vector<float>& levels, double binWidth, juce::Rectangle<int> area)
+{
+    using namespace juce;
+    
+    Path path;
+    const auto w = area.getWidth();
+    if (levels.size() < 2 || binWidth <= 0 || w < 2)
+        return path;
+    
+    //-96 dbfs at the bottom, 0 at the top
+    const double outputMin = area.getBottom();
+    const double outputMax = area.getY();
+    auto map = [outputMin, outputMax](float level) { return (float) jmap((double) level, -96.0, 0.0, outputMin, outputMax); };
+    
+    const auto lastBin = (double) levels.size() - 1;
+    double previousBin = -1;
+    
+    for (int x = 0; x <= w; x += 2)
     {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+        const auto bin = jmin(lastBin, mapToLog10((double) x / w, 20.0, 20000.0) / binWidth);
+        const auto index = jmin((size_t) bin, levels.size() - 2);
+        const auto fraction = (float) (bin - (double) index);
+        auto level = levels[index] + fraction * (levels[index + 1] - levels[index]);
+        
+        for (auto b = (size_t) (previousBin + 1.0); (double) b <= bin && previousBin >= 0; ++b)
+            level = jmax(level, levels[b]);
+        previousBin = bin;
+        
+        const auto y = jlimit((float) outputMax, (float) outputMin, map(level));
+        if (x == 0)
+            path.startNewSubPath((float) area.getX(), y);
+        else
+            path.lineTo((float) (area.getX() + x), y);
     }
     
+    return path;
+}
+} // namespace
+
+//set up timer callback
+void ResponseCurveComponent::timerCallback()
+{
+    //pick up a finished curve, unless the component got resized while it was being made
+    if (curveHandoff.pull())
+    {
+        const auto& result = curveHandoff.getReadBuffer();
+        if (result.bounds == getLocalBounds())
+        {
+            responseCurve = result.path;
+            //paint will stroke it into the image once, then just keep blitting that
+            curveImage = {};
+            repaint();
+        }
+    }
+    
+    //newest spectra from the analyzer thread, drawn behind the curve
+    if (audioProcessor.getAnalyzer().pullSpectrum())
+    {
+        const auto& spectrum = audioProcessor.getAnalyzer().getSpectrum();
+        const auto bounds = getLocalBounds();
+        preSpectrumPath = makeSpectrumPath(spectrum.pre, spectrum.binWidth, bounds);
+        postSpectrumPath = makeSpectrumPath(spectrum.post, spectrum.binWidth, bounds);
+        
+        //close the pre spectrum off along the bottom so it can be filled
+        if (! preSpectrumPath.isEmpty())
+        {
+            preSpectrumPath.lineTo(bounds.toFloat().getBottomRight());
+            preSpectrumPath.lineTo(bounds.toFloat().getBottomLeft());
+            preSpectrumPath.closeSubPath();
+        }
+        
+        repaint();
+    }
+    
+    //the load numbers only need to change a few times a second
+    if (--ticksUntilLoadRefresh <= 0)
+    {
+        ticksUntilLoadRefresh = loadRefreshTicks;
+        const auto stats = audioProcessor.getLoadStats();
+        
+        juce::String text;
+        if (stats.numBlocks > 0)
+        {
+            text << "dsp " << juce::String(stats.meanLoad * 100.0, 1) << "%  p99 " << juce::String(stats.p99Load * 100.0, 1)
+                 << "%  max " << juce::String(stats.maxLoad * 100.0, 1) << "%";
+            if (stats.numOverruns > 0)
+                text << "  overruns " << (juce::int64) stats.numOverruns;
+        }
+        
+        if (text != loadText)
+        {
+            loadText = text;
+            repaint();
+        }
+    }
+    
+    //see if it is true, if it is we want to set it back to false
+    //while a curve is still being made the flag stays set, so fast knob moves collapse into one update
+    if (! curveUpdateRunning.get() && parametersChanged.compareAndSetBool(false, true))
+        startCurveUpdate();
+}
+
+void ResponseCurveComponent::startCurveUpdate()
+{
+    //grab everything the job needs here on the message thread
+    auto chainSettings = getChainSettings(audioProcessor.getParameterHandles());
+    auto bankSettings = getBankSettings(audioProcessor.getBankParameterHandles());
+    //the editor can be open before the host has prepared us. with oversampling on the filters are designed at the higher rate
+    auto sampleRate = (audioProcessor.getSampleRate() > 0 ? audioProcessor.getSampleRate() : 44100.0) * audioProcessor.getOversamplingFactor();
+    auto bounds = getLocalBounds();
+    
+    if (bounds.isEmpty())
+        return;
+    
+    curveUpdateRunning.set(true);
+    curveThread.addJob([this, chainSettings, bankSettings, sampleRate, bounds]
+    {
+        auto& result = curveHandoff.getWriteBuffer();
+        result.bounds = bounds;
+        result.path = makeResponseCurve(chainSettings, bankSettings, sampleRate, bounds, curveResponse, coarseDecibels, curveDecibels);
+        curveHandoff.publish();
+        curveUpdateRunning.set(false);
+    });
+}
+
+void ResponseCurveComponent::resized()
+{
+    curveImage = {};
+    parametersChanged.set(true);
+}
+
+void ResponseCurveComponent::renderCurveImage(float scale)
+{
+    using namespace juce;
+    
+    //drawn at the display's pixel density so it stays sharp on hidpi screens
+    auto responseArea = getLocalBounds();
+    curveImage = Image(Image::ARGB, roundToInt(responseArea.getWidth() * scale), roundToInt(responseArea.getHeight() * scale), true);
+    curveImageScale = scale;
+    
+    Graphics g(curveImage);
+    g.addTransform(AffineTransform::scale(scale));
+    
+    //left transparent so the spectra show through from underneath
     // draw background
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f); //line thickness is 1
     // draw path
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));
+}
+
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+    //so we don't have to keep typing juce::..
+    using namespace juce;
     
+    // PREVIOUS CODE
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    // g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    // g.setColour (juce::Colours::white);
+    // g.setFont (juce::FontOptions (15.0f));
+    // g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
     
+    if (getLocalBounds().isEmpty())
+        return;
     
+    //only re-stroke when the curve or the display scale changed, everything else is a blit
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (! curveImage.isValid() || curveImageScale != scale)
+        renderCurveImage(scale);
     
-
+    g.fillAll (Colours::black);
+    
+    //input spectrum filled in the background, output spectrum as a line over it
+    g.setColour(Colours::grey.withAlpha(0.35f));
+    g.fillPath(preSpectrumPath);
+    g.setColour(Colours::skyblue.withAlpha(0.6f));
+    g.strokePath(postSpectrumPath, PathStrokeType(1.f));
     
+    g.drawImage(curveImage, getLocalBounds().toFloat());
+    
+    //how much of each block's deadline the processor is using, on top of everything
+    if (loadText.isNotEmpty())
+    {
+        g.setColour(Colours::lightgrey);
+        g.setFont(FontOptions(11.f));
+        g.drawText(loadText, getLocalBounds().reduced(6, 4), Justification::topLeft);
+    }
 }
 
 //==============================================================================
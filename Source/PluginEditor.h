@@ -38,14 +38,45 @@ juce::Timer
     void timerCallback() override;
     
     //need a paint function so declare one of those
+    //paint draws the analyzer spectra and blits the cached curve over them, the curve itself gets worked out on a background thread
     void paint(juce::Graphics& g) override;
+    //a new size needs a new curve
+    void resized() override;
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SimpleEQAudioProcessor& audioProcessor;
     //add atomic flag below processor
     juce::Atomic<bool> parametersChanged { false };
-    MonoChain monoChain;
+    
+    //what the background thread hands back: the path and the size it was built for
+    struct CurveResult {
+        juce::Rectangle<int> bounds;
+        juce::Path path;
+    };
+    
+    //kicks off a new curve on the background thread
+    void startCurveUpdate();
+    //strokes the current path into curveImage, once per new curve (or display scale)
+    void renderCurveImage(float scale);
+    
+    TripleBuffer<CurveResult> curveHandoff;
+    //only ever touched by the curve job: the frequency grid (kept until the size or sample rate changes) and its output
+    FrequencyResponse curveResponse;
+    std::vector<float> coarseDecibels, curveDecibels;
+    juce::Atomic<bool> curveUpdateRunning { false };
+    juce::Path responseCurve;
+    //analyzer output, rebuilt whenever a new spectrum comes in
+    juce::Path preSpectrumPath, postSpectrumPath;
+    juce::Image curveImage;
+    float curveImageScale { 0 };
+    //the dsp load readout in the corner, refreshed every loadRefreshTicks timer ticks
+    static constexpr int loadRefreshTicks = 15;
+    int ticksUntilLoadRefresh { 0 };
+    juce::String loadText;
+    
+    //declared last so it's gone (and its job finished) before anything the job touches
+    juce::ThreadPool curveThread { 1 };
 };
 //==============================================================================
 /**
@@ -22,10 +22,20 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    //same trick the response curve uses: listen to every parameter and just set a flag
+    for (auto* param : getParameters())
+        param->addListener(this);
+    
+    //pick up parameter changes on the message thread roughly every 10ms
+    startTimerHz(100);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    stopTimer();
+    kernelThread.removeAllJobs(true, 10000);
+    for (auto* param : getParameters())
+        param->removeListener(this);
 }
 
 //==============================================================================
@@ -63,7 +73,7 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -93,18 +103,110 @@ void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // prepare filters before we use them by passing a process spec object to the chain, which will pass it to each link in the chain
+    // prepare filters before we use them. the process spec describes what the host is going to send us
     juce::dsp::ProcessSpec spec;
     //needs to know the max number of samples that will pass through
     spec.maximumBlockSize = samplesPerBlock;
-    //mono chains can only handle one channel
+    //each lane group only sees one channel of SIMDRegisters
     spec.numChannels = 1;
     //needs to know the sample rate
     spec.sampleRate = sampleRate;
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
     
+    analyzer.setSampleRate(sampleRate);
+    //the deadline is the host's block at the host's rate, whatever we do inside it
+    loadMeter.prepare(sampleRate);
+    
+    //state for one group of SIMDRegister::size() channels each, all in one contiguous pool
+    numPreparedChannels = juce::jlimit(1, maxChannels, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    
+    //the host picks the precision before it prepares us
+    doublePrecisionActive = isUsingDoublePrecision();
+    
+    //a kernel job could still be writing into the convolver we are about to reallocate
+    kernelThread.removeAllJobs(true, 10000);
+    linearPhaseKernelJobRunning.set(false);
+    
+    //linear phase mode replaces the cascade (and oversampling) with one long fir
+    preparedPhaseMode = getPhaseModeChoice();
+    preparedLinearPhaseFftSize = getLinearPhaseFftSizeChoice();
+    preparedFilterEngine = getFilterEngineChoice();
+    stateVariableActive = preparedFilterEngine == 1;
+    linearPhaseActive = preparedPhaseMode == 1;
+    preparedStereoMode = getStereoModeChoice();
+    midSideActive = preparedStereoMode == 1 && numPreparedChannels == 2 && ! linearPhaseActive;
+    
+    //the whole cascade runs at the oversampled rate, so everything below gets sized and designed for that
+    prepareOversampling(samplesPerBlock);
+    spec.maximumBlockSize *= (juce::uint32) oversamplingFactor;
+    spec.sampleRate *= oversamplingFactor;
+    
+    //room for one block of interleaved samples per group, in the precision the host renders in
+    if (doublePrecisionActive)
+        doubleCascade.prepare(numPreparedChannels, (int) spec.maximumBlockSize, stateVariableActive, maxParametricBands);
+    else
+        floatCascade.prepare(numPreparedChannels, (int) spec.maximumBlockSize, stateVariableActive, maxParametricBands);
+    
+    //the state was just reset, so every band has to be designed and copied again
+    {
+        const juce::ScopedLock sl (designLock);
+        designedSampleRate = 0;
+    }
+    appliedVersions.fill(0);
+    appliedSideVersions.fill(0);
+    appliedBankVersions.fill(0);
+    bankBandInCascade.fill(false);
+    bankNeedsDesign.fill(false);
+    bankWeights.fill(0.f);
+    bankTargetWeights.fill(0.f);
+    bankHoldSamples.fill(0);
+    
+    //the audio thread isn't running yet, so design and apply straight away
     updateFilters();
+    coefficientHandoff.pull();
+    const auto& published = coefficientHandoff.getReadBuffer();
+    if (midSideActive)
+    {
+        sideCoefficientHandoff.pull();
+        sideTargetSettings = sideCoefficientHandoff.getReadBuffer().settings;
+    }
+    
+    //start exactly where the parameters are, no ramp on the first block
+    appliedSmoothingSeconds = smoothingSeconds.load();
+    lowCutFreqSmoother.reset(spec.sampleRate, appliedSmoothingSeconds);
+    highCutFreqSmoother.reset(spec.sampleRate, appliedSmoothingSeconds);
+    peakFreqSmoother.reset(spec.sampleRate, appliedSmoothingSeconds);
+    peakGainSmoother.reset(spec.sampleRate, appliedSmoothingSeconds);
+    peakQualitySmoother.reset(spec.sampleRate, appliedSmoothingSeconds);
+    resetBankSmoothers(spec.sampleRate, appliedSmoothingSeconds);
+    elisionFadeSamples = juce::jmax(1, juce::roundToInt(spec.sampleRate * 0.01));
+    resetSmoothers(published.settings);
+    applyPublishedBands(published);
+    if (midSideActive)
+        applySideBands(sideCoefficientHandoff.getReadBuffer());
+    bankHandoff.pull();
+    applyBankBands(bankHandoff.getReadBuffer());
+    finishBankRamps(bankHandoff.getReadBuffer());
+    
+    //timestamps for pushParameterChange are counted from here
+    samplePosition = 0;
+    
+    if (linearPhaseActive)
+        prepareLinearPhase();
+    
+    //everything was just reset, so there's nothing left to ring out
+    silentSamples = 0;
+    sleeping = false;
+    matchingSamples = std::numeric_limits<juce::int64>::max() / 2;
+    {
+        const juce::ScopedLock sl (designLock);
+        updateTailLength();
+    }
+    
+    //whatever mode we're in, the host has to know exactly how late our output is
+    setLatencySamples(linearPhaseActive ? linearPhase.getLatencySamples()
+                      : oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples())
+                      : doubleOversampler != nullptr ? juce::roundToInt(doubleOversampler->getLatencyInSamples())
+                      : 0);
     
     
 
@@ -126,11 +228,10 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // every channel runs through the same filters, so any layout works as long as the chain pool can hold it
+    // (mono, stereo, surround like 7.1.4, 3rd order ambisonics...)
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -148,10 +249,24 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 // in order to make a processing context, we need to supply it with an audio block instance (juce::AudioBuffer<>)
 // need to extract the left and right channel from this bufer (typically channels 0 and 1)
 
-void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    jassert(! doublePrecisionActive);
+    processSamples(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    jassert(doublePrecisionActive);
+    processSamples(buffer);
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
 {
     //std::cout << "entering process block" << std::endl;
     juce::ScopedNoDenormals noDenormals;
+    const DSPLoadMeter::ScopedBlock loadScope (loadMeter, buffer.getNumSamples());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -172,7 +287,29 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     //we want to copy values over so we want to dereference it
     
     //made the following refactoring functions
-    updateFilters();
+    //offline renders aren't real time, so keep automation exact by designing right here instead of waiting for the timer
+    if (isNonRealtime() && parametersChanged.compareAndSetBool(false, true))
+        updateFilters();
+    
+    //a new ramp length jumps the smoothers to their targets, then later moves ramp with the new length
+    if (const auto seconds = smoothingSeconds.load(); seconds != appliedSmoothingSeconds)
+    {
+        appliedSmoothingSeconds = seconds;
+        lowCutFreqSmoother.reset(getProcessingSampleRate(), seconds);
+        highCutFreqSmoother.reset(getProcessingSampleRate(), seconds);
+        peakFreqSmoother.reset(getProcessingSampleRate(), seconds);
+        peakGainSmoother.reset(getProcessingSampleRate(), seconds);
+        peakQualitySmoother.reset(getProcessingSampleRate(), seconds);
+        resetBankSmoothers(getProcessingSampleRate(), seconds);
+    }
+    
+    //coefficients are designed on the message thread, here we only pick up the newest set (no locks, no allocation)
+    if (coefficientHandoff.pull())
+        startRampTowards(coefficientHandoff.getReadBuffer());
+    if (midSideActive && sideCoefficientHandoff.pull())
+        applySideBands(sideCoefficientHandoff.getReadBuffer());
+    if (bankHandoff.pull())
+        applyBankBands(bankHandoff.getReadBuffer());
 //    updatePeakFilter(chainSettings);
 //    
 //    
@@ -325,19 +462,172 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
 //    //call new functionlo
 //    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    //only the channels we prepared for get filtered
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), numPreparedChannels);
+    
+    //only costs anything while the editor is showing it
+    const auto analyzerActive = analyzer.isActive();
+    if (analyzerActive)
+        analyzer.pushPre(buffer, numChannels, numSamples);
+    
+    //how long whatever the filters are holding takes to ring out, plus our latency
+    const auto ringOutSamples = (juce::int64) std::ceil(tailLengthSeconds.load() * getSampleRate()) + getLatencySamples();
+    
+    //digital silence in, and the input before this block was already silent for longer than the tail takes to ring out:
+    //nothing we'd output is audible, so flush the state and skip the filters until sound comes back
+    if (silenceDetection.load(std::memory_order_relaxed))
+    {
+        auto inputSilent = true;
+        for (int ch = 0; ch < numChannels && inputSilent; ++ch)
+            inputSilent = buffer.getMagnitude(ch, 0, numSamples) <= (SampleType) silenceThreshold;
+        
+        if (! inputSilent)
+            sleeping = false;
+        else if (! sleeping && silentSamples > ringOutSamples)
+        {
+            //every lane is zero now, so they already match however long the channels have
+            flushState();
+            matchingSamples = std::numeric_limits<juce::int64>::max() / 2;
+            sleeping = true;
+        }
+        
+        silentSamples = inputSilent ? silentSamples + numSamples : 0;
+    }
+    else if (sleeping)
+    {
+        silentSamples = 0;
+        sleeping = false;
+    }
+    
+    if (sleeping)
+    {
+        //timestamped changes still land, so we wake up with the right settings
+        ParameterEvent event;
+        while (parameterEvents.popIfBefore(samplePosition + numSamples, event))
+            applyParameterEvent(event);
+        samplePosition += numSamples;
+        finishRamps();
+        
+        //the buffer is left as it came in, silent
+        if (analyzerActive)
+            analyzer.pushPost(buffer, numChannels, numSamples);
+        return;
+    }
+    
+    //a mono layout is one lane of one group already. identical channels get the same treatment: filter the first one,
+    //copy it to the rest afterwards
+    auto channelsMatch = [&]
+    {
+        const auto* first = buffer.getReadPointer(0);
+        for (int ch = 1; ch < numChannels; ++ch)
+            if (! std::equal(first, first + numSamples, buffer.getReadPointer(ch)))
+                return false;
+        return true;
+    };
     
-    //extract individual channels using helper
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    //mid/side gives the two lanes different filters, so there's nothing to share there
+    const auto midSide = midSideActive && numChannels == 2;
+    const auto channelsIdentical = numChannels > 1 && ! midSide && dualMonoDetection.load(std::memory_order_relaxed) && channelsMatch();
     
-    //create processing contexts that wrap each individual audio block
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    //identical input doesn't mean identical state yet: stereo that goes quiet matches straight away while every lane is
+    //still ringing out its own past. only once the channels have matched for longer than the tail has that all died away,
+    //before then filtering just the first one would swap the others' tails for its own
+    const auto dualMono = channelsIdentical && matchingSamples > ringOutSamples;
+    matchingSamples = channelsIdentical ? matchingSamples + numSamples : 0;
+    if (dualMonoActive.load(std::memory_order_relaxed) && ! dualMono)
+        splitDualMonoState(numChannels);
+    dualMonoActive.store(dualMono, std::memory_order_relaxed);
+    const auto numFilteredChannels = dualMono ? 1 : numChannels;
     
-    //pass contexts to mono filter chains
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    //linear phase mode: the convolver does everything, the cascade doesn't run at all
+    if (linearPhaseActive)
+    {
+        //offline renders design the kernel right here so no change gets missed
+        if (isNonRealtime() && linearPhaseKernelWanted.get() && ! linearPhaseKernelJobRunning.get() && linearPhase.isReadyForKernel())
+        {
+            linearPhaseKernelWanted.set(false);
+            designLinearPhaseKernel(getChainSettings(parameterHandles), getBankSettings(bankParameterHandles));
+        }
+        
+        //the kernel only follows the parameters, timestamped changes just keep the smoothers up to date for when we switch back
+        ParameterEvent event;
+        while (parameterEvents.popIfBefore(samplePosition + numSamples, event))
+            applyParameterEvent(event);
+        samplePosition += numSamples;
+        
+        auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, (size_t) numFilteredChannels);
+        linearPhase.process(block);
+        
+        for (int ch = numFilteredChannels; ch < numChannels; ++ch)
+            buffer.copyFrom(ch, 0, buffer, 0, 0, numSamples);
+        
+        if (analyzerActive)
+            analyzer.pushPost(buffer, numChannels, numSamples);
+        return;
+    }
+    
+    //with oversampling on, everything from here to the downsampling runs on the oversampled block
+    auto* blockOversampler = getOversampler<SampleType>();
+    auto hostBlock = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, (size_t) numChannels);
+    auto processingBlock = blockOversampler != nullptr ? blockOversampler->processSamplesUp(hostBlock) : hostBlock;
+    const auto numProcessingSamples = (int) processingBlock.getNumSamples();
+    
+    //the kernel wants one SIMDRegister per sample, so the channels get interleaved (one channel per lane) and back every block
+    auto& cascade = getCascade<SampleType>();
+    const auto blockEnd = samplePosition + numSamples;
+    
+    //every band elided and nothing on its way to bring one back: the cascade would only copy the block, so skip it
+    //(and the interleaving) altogether
+    updateElision();
+    if (cascade.isEmpty() && ! isCascadeMoving() && ! parameterEvents.hasEventBefore(blockEnd))
+    {
+        samplePosition = blockEnd;
+    }
+    else
+    {
+        //the host promised never to go over the block size from prepareToPlay
+        jassert((size_t) numProcessingSamples <= cascade.getMaxBlockSize());
+        if (midSide)
+            cascade.interleaveMidSide(processingBlock, numProcessingSamples);
+        else
+            cascade.interleave(processingBlock, numFilteredChannels, numProcessingSamples);
+        
+        //one pass through all the filters takes care of a whole group of channels
+        //timestamped changes split the block exactly where they land, ramps split it on the update grid
+        const auto numGroups = FilterCascade<SampleType>::getNumGroups(numFilteredChannels);
+        int position = 0;
+        ParameterEvent event;
+        
+        while (parameterEvents.popIfBefore(blockEnd, event))
+        {
+            //anything that arrived late gets applied at the start of this block. event times are in host samples
+            const auto offset = (int) juce::jlimit<juce::int64>(position, numProcessingSamples,
+                                                                (event.samplePosition - samplePosition) * oversamplingFactor);
+            processSegment(position, offset - position, numGroups);
+            applyParameterEvent(event);
+            position = offset;
+        }
+        
+        processSegment(position, numProcessingSamples - position, numGroups);
+        samplePosition = blockEnd;
+        
+        //and back out into the host's buffer (or the oversampled one)
+        if (midSide)
+            cascade.deinterleaveMidSide(processingBlock, numProcessingSamples);
+        else
+            cascade.deinterleave(processingBlock, numFilteredChannels, numProcessingSamples);
+        
+        //the oversampler still runs every channel, so its state never needs fixing up
+        for (int ch = numFilteredChannels; ch < numChannels; ++ch)
+            processingBlock.getSingleChannelBlock((size_t) ch).copyFrom(processingBlock.getSingleChannelBlock(0));
+    }
+    
+    if (blockOversampler != nullptr)
+        blockOversampler->processSamplesDown(hostBlock);
+    
+    if (analyzerActive)
+        analyzer.pushPost(buffer, numChannels, numSamples);
 
     
 }
@@ -391,73 +681,1425 @@ ChainSettings getChainSettings (juce::AudioProcessorValueTreeState& apvts) {
     settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
     settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
     settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutSlope = combineSlopes(apvts.getRawParameterValue("LowCut Slope")->load(), apvts.getRawParameterValue("LowCut Steep Slope")->load());
+    settings.highCutSlope = combineSlopes(apvts.getRawParameterValue("HighCut Slope")->load(), apvts.getRawParameterValue("HighCut Steep Slope")->load());
     return settings;
 }
 
-//implement free function
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+Slope combineSlopes(float slopeChoice, float steepSlopeChoice) {
+    const auto steep = juce::jlimit(0, numSteepSlopes, juce::roundToInt(steepSlopeChoice));
+    if (steep > 0)
+        return static_cast<Slope>(Slope_48 + steep);
+    
+    return static_cast<Slope>(juce::jlimit(0, (int) Slope_48, juce::roundToInt(slopeChoice)));
+}
+
+const char* ChainParameterHandles::getParameterID(ChainParameter param) {
+    //same order as the ChainParameter enum
+    static const char* const ids[] = {
+        "LowCut Freq",
+        "HighCut Freq",
+        "Peak Freq",
+        "Peak Gain",
+        "Peak Quality",
+        "LowCut Slope",
+        "HighCut Slope",
+        "LowCut Steep Slope",
+        "HighCut Steep Slope"
+    };
+    static_assert(std::size(ids) == NumChainParameters, "every chain parameter needs an id");
+    
+    jassert(param >= 0 && param < NumChainParameters);
+    return ids[param];
+}
+
+ChainParameterHandles::ChainParameterHandles(juce::AudioProcessorValueTreeState& apvts, const juce::String& idPrefix) {
+    //the only place we search by string
+    for (int i = 0; i < NumChainParameters; ++i)
+    {
+        handles[i] = apvts.getRawParameterValue(idPrefix + getParameterID(static_cast<ChainParameter>(i)));
+        //if this fires the id table and createParameterLayout have drifted apart
+        jassert(handles[i] != nullptr);
+    }
+}
+
+ChainSettings getChainSettings(const ChainParameterHandles& handles) {
+    ChainSettings settings;
+    settings.lowCutFreq = handles.load<LowCutFreqParam>();
+    settings.highCutFreq = handles.load<HighCutFreqParam>();
+    settings.peakFreq = handles.load<PeakFreqParam>();
+    settings.peakGainInDecibels = handles.load<PeakGainParam>();
+    settings.peakQuality = handles.load<PeakQualityParam>();
+    settings.lowCutSlope = combineSlopes(handles.load<LowCutSlopeParam>(), handles.load<LowCutSteepSlopeParam>());
+    settings.highCutSlope = combineSlopes(handles.load<HighCutSlopeParam>(), handles.load<HighCutSteepSlopeParam>());
+    return settings;
+}
+
+BankParameterHandles::BankParameterHandles(juce::AudioProcessorValueTreeState& apvts) {
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        for (int i = 0; i < NumBandParameters; ++i)
+        {
+            handles[(size_t) band][(size_t) i] = apvts.getRawParameterValue(getParameterID(band, static_cast<BandParameter>(i)));
+            jassert(handles[(size_t) band][(size_t) i] != nullptr);
+        }
+    }
+}
+
+juce::String BankParameterHandles::getParameterID(int band, BandParameter param) {
+    static const char* const names[NumBandParameters] = { "Type", "Freq", "Gain", "Quality" };
+    return "Band " + juce::String(band + 1) + " " + names[param];
+}
+
+BankSettings getBankSettings(const BankParameterHandles& handles) {
+    BankSettings settings;
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        auto& bandSettings = settings[(size_t) band];
+        bandSettings.type = static_cast<BandType>(juce::roundToInt(handles.load(band, BandTypeParam)));
+        bandSettings.freq = handles.load(band, BandFreqParam);
+        bandSettings.gainInDecibels = handles.load(band, BandGainParam);
+        bandSettings.quality = handles.load(band, BandQualityParam);
+    }
+    return settings;
+}
+
+ChainCoefficients::Biquad makePeakBiquad(const ChainSettings& chainSettings, double sampleRate)
+{
+    return designPeakBiquad(sampleRate,
+                            chainSettings.peakFreq,
+                            chainSettings.peakQuality,
+                            juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+void makeLowCutBiquads(std::array<ChainCoefficients::Biquad, maxCutSections>& biquads, const ChainSettings& chainSettings, double sampleRate)
+{
+    //low cut means you need the high pass
+    //order 2 * (slope + 1) gives us slope + 1 biquads, the rest stay unused (and bypassed)
+    designButterworthSections(biquads, true, sampleRate, chainSettings.lowCutFreq, 2 * (chainSettings.lowCutSlope + 1));
+}
+
+void makeHighCutBiquads(std::array<ChainCoefficients::Biquad, maxCutSections>& biquads, const ChainSettings& chainSettings, double sampleRate)
+{
+    designButterworthSections(biquads, false, sampleRate, chainSettings.highCutFreq, 2 * (chainSettings.highCutSlope + 1));
+}
+
+SVFArray makePeakSVF(const ChainSettings& chainSettings, double sampleRate)
+{
+    return designPeakSVF(sampleRate,
+                         chainSettings.peakFreq,
+                         chainSettings.peakQuality,
+                         juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
+
+void makeLowCutSVFs(std::array<SVFArray, maxCutSections>& svfs, const ChainSettings& chainSettings, double sampleRate)
+{
+    designButterworthSVFSections(svfs, true, sampleRate, chainSettings.lowCutFreq, 2 * (chainSettings.lowCutSlope + 1));
+}
+
+void makeHighCutSVFs(std::array<SVFArray, maxCutSections>& svfs, const ChainSettings& chainSettings, double sampleRate)
+{
+    designButterworthSVFSections(svfs, false, sampleRate, chainSettings.highCutFreq, 2 * (chainSettings.highCutSlope + 1));
+}
+
+void designLowCutBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache)
+{
+    CoefficientCache::Key key;
+    key.band = ChainPositions::LowCut;
+    key.slope = chainSettings.lowCutSlope;
+    key.frequency = juce::roundToInt(chainSettings.lowCutFreq);
+    key.sampleRate = sampleRate;
+    
+    if (auto* cached = cache != nullptr ? cache->find(key) : nullptr)
+    {
+        chainCoefficients.lowCut = *cached;
+    }
+    else
+    {
+        //design from the rounded value so a cached design and a fresh one are always identical
+        auto settings = chainSettings;
+        settings.lowCutFreq = (float) key.frequency;
+        
+        makeLowCutBiquads(chainCoefficients.lowCut, settings, sampleRate);
+        
+        if (cache != nullptr)
+            cache->insert(key, chainCoefficients.lowCut);
+    }
+    
+    chainCoefficients.lowCutSlope = chainSettings.lowCutSlope;
+    ++chainCoefficients.versions[ChainPositions::LowCut];
+}
+
+void designPeakBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache)
+{
+    CoefficientCache::Key key;
+    key.band = ChainPositions::Peak;
+    key.frequency = juce::roundToInt(chainSettings.peakFreq);
+    key.halfDecibels = juce::roundToInt(chainSettings.peakGainInDecibels * 2.f);
+    key.qualityTwentieths = juce::roundToInt(chainSettings.peakQuality * 20.f);
+    key.sampleRate = sampleRate;
+    
+    if (auto* cached = cache != nullptr ? cache->find(key) : nullptr)
+    {
+        chainCoefficients.peak = cached->front();
+    }
+    else
+    {
+        auto settings = chainSettings;
+        settings.peakFreq = (float) key.frequency;
+        settings.peakGainInDecibels = key.halfDecibels * 0.5f;
+        settings.peakQuality = key.qualityTwentieths * 0.05f;
+        
+        chainCoefficients.peak = makePeakBiquad(settings, sampleRate);
+        
+        if (cache != nullptr)
+            cache->insert(key, { chainCoefficients.peak });
+    }
+    
+    ++chainCoefficients.versions[ChainPositions::Peak];
+}
+
+void designHighCutBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache)
+{
+    CoefficientCache::Key key;
+    key.band = ChainPositions::HighCut;
+    key.slope = chainSettings.highCutSlope;
+    key.frequency = juce::roundToInt(chainSettings.highCutFreq);
+    key.sampleRate = sampleRate;
+    
+    if (auto* cached = cache != nullptr ? cache->find(key) : nullptr)
+    {
+        chainCoefficients.highCut = *cached;
+    }
+    else
+    {
+        auto settings = chainSettings;
+        settings.highCutFreq = (float) key.frequency;
+        
+        makeHighCutBiquads(chainCoefficients.highCut, settings, sampleRate);
+        
+        if (cache != nullptr)
+            cache->insert(key, chainCoefficients.highCut);
+    }
+    
+    chainCoefficients.highCutSlope = chainSettings.highCutSlope;
+    ++chainCoefficients.versions[ChainPositions::HighCut];
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    ChainCoefficients chainCoefficients;
+    designLowCutBand(chainCoefficients, chainSettings, sampleRate);
+    designPeakBand(chainCoefficients, chainSettings, sampleRate);
+    designHighCutBand(chainCoefficients, chainSettings, sampleRate);
+    return chainCoefficients;
+}
+
+BiquadArray makeBandBiquad(const BandSettings& bandSettings, double sampleRate)
+{
+    const auto gainFactor = juce::Decibels::decibelsToGain((double) bandSettings.gainInDecibels);
+    
+    switch (bandSettings.type) {
+        case Band_Peak: return designPeakBiquad(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_LowShelf: return designLowShelfBiquad(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_HighShelf: return designHighShelfBiquad(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_Notch: return designNotchBiquad(sampleRate, bandSettings.freq, bandSettings.quality);
+        case Band_Off: break;
+    }
+    return { 1.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+BankCoefficients makeBankCoefficients(const BankSettings& bankSettings, double sampleRate)
+{
+    BankCoefficients bankCoefficients;
+    for (size_t band = 0; band < bankSettings.size(); ++band)
+    {
+        bankCoefficients.biquads[band] = makeBandBiquad(bankSettings[band], sampleRate);
+        bankCoefficients.active[band] = ! isTransparentBand(bankSettings[band]);
+    }
+    bankCoefficients.settings = bankSettings;
+    return bankCoefficients;
+}
+
+int getActiveBankBiquads(const BankCoefficients& bankCoefficients, BiquadArray* biquads)
+{
+    int numBiquads = 0;
+    for (size_t band = 0; band < bankCoefficients.biquads.size(); ++band)
+        if (bankCoefficients.active[band])
+            biquads[numBiquads++] = bankCoefficients.biquads[band];
+    
+    return numBiquads;
+}
+
+void makeLinearPhaseImpulse(std::vector<float>& impulse, const ChainSettings& chainSettings, const BankSettings& bankSettings,
+                            double sampleRate, int length)
+{
+    //the magnitude comes from the chain designed at 4x the rate, so it follows the analog shape instead of cramping near nyquist
+    const auto designRate = sampleRate * 4.0;
+    std::array<BiquadArray, maxResponseBiquads> biquads;
+    auto numBiquads = getActiveBiquads(makeChainCoefficients(chainSettings, designRate), biquads);
+    numBiquads += getActiveBankBiquads(makeBankCoefficients(bankSettings, designRate), biquads.data() + numBiquads);
+    
+    //one point per bin of a length point fft
+    const auto numBins = length / 2 + 1;
+    std::vector<double> frequencies((size_t) numBins);
+    for (int bin = 0; bin < numBins; ++bin)
+        frequencies[(size_t) bin] = bin * sampleRate / length;
+    
+    FrequencyResponse response;
+    response.prepare(frequencies, designRate);
+    std::vector<float> decibels((size_t) numBins);
+    response.evaluate(biquads.data(), numBiquads, decibels.data());
+    
+    //zero phase spectrum, so the inverse fft comes out symmetric around sample 0
+    std::vector<float> spectrum((size_t) length * 2, 0.f);
+    for (int bin = 0; bin < numBins; ++bin)
+        spectrum[(size_t) bin * 2] = juce::Decibels::decibelsToGain(decibels[(size_t) bin], -100.f);
+    
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(length)));
+    fft.performRealOnlyInverseTransform(spectrum.data());
+    
+    //rotate the peak to the middle and window the length - 1 taps around it. odd length and symmetric means exactly linear phase
+    impulse.assign((size_t) length, 0.f);
+    const auto half = length / 2;
+    for (int n = 1; n < length; ++n)
+    {
+        const auto x = juce::MathConstants<double>::twoPi * (n - 1) / (length - 2);
+        const auto blackman = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2.0 * x);
+        impulse[(size_t) n] = (float) (spectrum[(size_t) ((n - half + length) % length)] * blackman);
+    }
+}
+
+int getActiveBiquads(const ChainCoefficients& chainCoefficients, std::array<BiquadArray, maxResponseBiquads>& biquads)
+{
+    int numBiquads = 0;
+    for (int stage = 0; stage <= chainCoefficients.lowCutSlope; ++stage)
+        biquads[(size_t) numBiquads++] = chainCoefficients.lowCut[(size_t) stage];
+    
+    biquads[(size_t) numBiquads++] = chainCoefficients.peak;
+    
+    for (int stage = 0; stage <= chainCoefficients.highCutSlope; ++stage)
+        biquads[(size_t) numBiquads++] = chainCoefficients.highCut[(size_t) stage];
+    
+    return numBiquads;
+}
+
+//the parameters are stepped, so comparing the floats exactly is fine here
+bool lowCutSettingsDiffer(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.lowCutFreq != b.lowCutFreq || a.lowCutSlope != b.lowCutSlope;
+}
+
+bool peakSettingsDiffer(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq != b.peakFreq || a.peakGainInDecibels != b.peakGainInDecibels || a.peakQuality != b.peakQuality;
+}
+
+bool highCutSettingsDiffer(const ChainSettings& a, const ChainSettings& b)
 {
-    //this was originally in updatepeakfilter
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq,
-                                                               chainSettings.peakQuality,
-                                                               juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    return a.highCutFreq != b.highCutFreq || a.highCutSlope != b.highCutSlope;
+}
+
+bool bandSettingsDiffer(const BandSettings& a, const BandSettings& b)
+{
+    return a.type != b.type || a.freq != b.freq || a.gainInDecibels != b.gainInDecibels || a.quality != b.quality;
+}
+
+bool isTransparentBand(const ChainSettings& chainSettings, ChainPositions band)
+{
+    //the ends of the parameter ranges, and how close to 0db the peak has to be to count as flat
+    constexpr float lowestCutFrequency = 20.f, highestCutFrequency = 20000.f, transparentPeakDecibels = 0.01f;
+    
+    switch (band) {
+        case LowCut: return chainSettings.lowCutFreq <= lowestCutFrequency;
+        case Peak: return std::abs(chainSettings.peakGainInDecibels) < transparentPeakDecibels;
+        case HighCut: return chainSettings.highCutFreq >= highestCutFrequency;
+    }
+    return false;
+}
+
+bool isTransparentBand(const BandSettings& bandSettings)
+{
+    //same threshold as the fixed peak
+    constexpr float transparentDecibels = 0.01f;
+    
+    switch (bandSettings.type) {
+        case Band_Off: return true;
+        case Band_Peak:
+        case Band_LowShelf:
+        case Band_HighShelf: return std::abs(bandSettings.gainInDecibels) < transparentDecibels;
+        case Band_Notch: return false;
+    }
+    return true;
+}
+
+double getBandDecaySamples(const ChainCoefficients& chainCoefficients, ChainPositions band, double decibels)
+{
+    switch (band) {
+        case LowCut: return getCascadeDecaySamples(chainCoefficients.lowCut.data(), chainCoefficients.lowCutSlope + 1, decibels);
+        case Peak: return getCascadeDecaySamples(&chainCoefficients.peak, 1, decibels);
+        case HighCut: return getCascadeDecaySamples(chainCoefficients.highCut.data(), chainCoefficients.highCutSlope + 1, decibels);
+    }
+    return 0;
 }
 
 //implement refactoring function beneath where we are getting the chain settings
 //copy the implementation from the process block (paste here), repaste in process block & do the same thing in prepare to play
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings) {
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainCoefficients &chainCoefficients, StereoChain chain) {
     
-    //call the makePeakFilter function
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
-    //access coefficients using .coefficients and assign what we wrote above
-    //dereference them using * on both sides
+    //the peak coefficients were already designed by makeChainCoefficients (off the audio thread)
     //at this point the peak has been set up and will make audible changes to audio running through it if the gain parameter is not 0
-    //whenever the slider changes we need to update the filter with new coefficients whenever the slider changes (do it next in process block)
     //use update coefficients function
     //*leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
     //*rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    //every group shares the one set of coefficients
+    //remember what the band was given, a fade in or out writes it again from here
+    auto& applied = appliedCoefficients[chain];
+    applied.peak = chainCoefficients.peak;
+    applied.settings.peakFreq = chainCoefficients.settings.peakFreq;
+    applied.settings.peakGainInDecibels = chainCoefficients.settings.peakGainInDecibels;
+    applied.settings.peakQuality = chainCoefficients.settings.peakQuality;
+    const auto weight = bandWeights[ChainPositions::Peak];
+    
+    //the svf engine designs its own straight from the settings, that's cheap enough to do right here
+    if (stateVariableActive)
+        setCascadeSVFStage(peakSlot, fadeSVF(makePeakSVF(chainCoefficients.settings, getProcessingSampleRate()), weight), chain);
+    else
+        setCascadeStage(peakSlot, fadeBiquad(chainCoefficients.peak, weight), chain);
+}
+
+void SimpleEQAudioProcessor::updateLowCutFilters(const ChainCoefficients &chainCoefficients, StereoChain chain) {
+    auto& applied = appliedCoefficients[chain];
+    applied.lowCut = chainCoefficients.lowCut;
+    applied.lowCutSlope = chainCoefficients.lowCutSlope;
+    applied.settings.lowCutFreq = chainCoefficients.settings.lowCutFreq;
+    applied.settings.lowCutSlope = chainCoefficients.settings.lowCutSlope;
+    const auto weight = bandWeights[ChainPositions::LowCut];
+    
+    //the unused stages just keep their old values, the kernel for this slope never touches them.
+    //except in mid/side, where the other chain's slope can make it run them, so they pass this lane straight through
+    const auto numUsed = midSideActive ? maxCutSections : chainCoefficients.lowCutSlope + 1;
+    
+    if (stateVariableActive)
+    {
+        std::array<SVFArray, maxCutSections> svfs;
+        svfs.fill(makeSVF(0.0, 0.0, 1.0, 0.0, 0.0));
+        makeLowCutSVFs(svfs, chainCoefficients.settings, getProcessingSampleRate());
+        for (int i = 0; i < numUsed; ++i)
+            setCascadeSVFStage(getLowCutSlot(i), fadeSVF(svfs[(size_t) i], weight), chain);
+        return;
+    }
+    
+    for (int i = 0; i < numUsed; ++i)
+        setCascadeStage(getLowCutSlot(i), i <= chainCoefficients.lowCutSlope ? fadeBiquad(chainCoefficients.lowCut[(size_t) i], weight)
+                                                                             : BiquadArray { 1.0, 0.0, 0.0, 0.0, 0.0 }, chain);
+}
+
+void SimpleEQAudioProcessor::updateHighCutFilters(const ChainCoefficients &chainCoefficients, StereoChain chain) {
+    auto& applied = appliedCoefficients[chain];
+    applied.highCut = chainCoefficients.highCut;
+    applied.highCutSlope = chainCoefficients.highCutSlope;
+    applied.settings.highCutFreq = chainCoefficients.settings.highCutFreq;
+    applied.settings.highCutSlope = chainCoefficients.settings.highCutSlope;
+    const auto weight = bandWeights[ChainPositions::HighCut];
+    const auto numUsed = midSideActive ? maxCutSections : chainCoefficients.highCutSlope + 1;
+    
+    if (stateVariableActive)
+    {
+        std::array<SVFArray, maxCutSections> svfs;
+        svfs.fill(makeSVF(0.0, 0.0, 1.0, 0.0, 0.0));
+        makeHighCutSVFs(svfs, chainCoefficients.settings, getProcessingSampleRate());
+        for (int i = 0; i < numUsed; ++i)
+            setCascadeSVFStage(getHighCutSlot(i), fadeSVF(svfs[(size_t) i], weight), chain);
+        return;
+    }
+    
+    for (int i = 0; i < numUsed; ++i)
+        setCascadeStage(getHighCutSlot(i), i <= chainCoefficients.highCutSlope ? fadeBiquad(chainCoefficients.highCut[(size_t) i], weight)
+                                                                               : BiquadArray { 1.0, 0.0, 0.0, 0.0, 0.0 }, chain);
+}
+
+void SimpleEQAudioProcessor::updateBand(ChainPositions band, const ChainCoefficients &chainCoefficients, StereoChain chain) {
+    switch (band) {
+        case LowCut: updateLowCutFilters(chainCoefficients, chain); break;
+        case Peak: updatePeakFilter(chainCoefficients, chain); break;
+        case HighCut: updateHighCutFilters(chainCoefficients, chain); break;
+    }
+}
+
+void SimpleEQAudioProcessor::rewriteBand(ChainPositions band) {
+    updateBand(band, appliedCoefficients[MainChain], MainChain);
+    if (midSideActive)
+        updateBand(band, appliedCoefficients[SideChain], SideChain);
+}
+
+void SimpleEQAudioProcessor::applySideBands(const ChainCoefficients &published) {
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        if (published.versions[band] != appliedSideVersions[band])
+        {
+            updateBand(band, published, SideChain);
+            appliedSideVersions[band] = published.versions[band];
+        }
+    }
+    
+    //a new side slope can change how many stages the kernel runs
+    sideTargetSettings = published.settings;
+    setCascadeStageCounts(targetSettings);
+}
+
+void SimpleEQAudioProcessor::applyBankBands(const BankCoefficients &published) {
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        const auto b = (size_t) band;
+        if (published.versions[b] == appliedBankVersions[b])
+            continue;
+        
+        appliedBankVersions[b] = published.versions[b];
+        const auto& target = published.settings[b];
+        
+        if (! published.active[b])
+        {
+            //fades out on the design it has now, then rings out dry
+            snapBankSmoothers(band, { target.type, bankFreqSmoothers[b].getCurrentValue(),
+                                      bankGainSmoothers[b].getCurrentValue(), bankQualitySmoothers[b].getCurrentValue() });
+            bankTargetWeights[b] = 0.f;
+            bankNeedsDesign[b] = false;
+            if (bankBandInCascade[b] && bankWeights[b] == 0.f && bankHoldSamples[b] == 0)
+                bankHoldSamples[b] = getBankHoldSamples(band);
+        }
+        else if (! bankBandInCascade[b] || bankWeights[b] == 0.f)
+        {
+            //nothing of it is in the path: start it dry on the new design and fade it in.
+            //a band that was ringing out just carries on from where its state is
+            snapBankSmoothers(band, target);
+            appliedBankTypes[b] = target.type;
+            appliedBankBiquads[b] = published.biquads[b];
+            bankBandInCascade[b] = true;
+            bankHoldSamples[b] = 0;
+            bankTargetWeights[b] = 1.f;
+            writeBankBand(band);
+        }
+        else if (target.type != appliedBankTypes[b])
+        {
+            //the old type fades out where it is, advanceBankFades brings the new one in
+            snapBankSmoothers(band, { target.type, bankFreqSmoothers[b].getCurrentValue(),
+                                      bankGainSmoothers[b].getCurrentValue(), bankQualitySmoothers[b].getCurrentValue() });
+            bankTargetWeights[b] = 0.f;
+            bankNeedsDesign[b] = false;
+        }
+        else
+        {
+            //same type: ramp there, starting with a design for the rest of the current cell
+            bankFreqSmoothers[b].setTargetValue(target.freq);
+            bankGainSmoothers[b].setTargetValue(target.gainInDecibels);
+            bankQualitySmoothers[b].setTargetValue(target.quality);
+            bankTargetWeights[b] = 1.f;
+            bankNeedsDesign[b] = true;
+        }
+    }
+}
+
+bool SimpleEQAudioProcessor::isBankRamping(int band) const {
+    const auto b = (size_t) band;
+    return bankFreqSmoothers[b].isSmoothing() || bankGainSmoothers[b].isSmoothing() || bankQualitySmoothers[b].isSmoothing();
+}
+
+bool SimpleEQAudioProcessor::isBankMoving() const {
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        const auto b = (size_t) band;
+        //ramping, fading, or faded out and waiting to be dropped
+        if (bankNeedsDesign[b] || isBankRamping(band) || bankWeights[b] != bankTargetWeights[b]
+            || (bankBandInCascade[b] && bankTargetWeights[b] == 0.f))
+            return true;
+    }
+    return false;
+}
+
+void SimpleEQAudioProcessor::designBankBand(int band, int numSamples, const BankCoefficients &published) {
+    const auto b = (size_t) band;
+    
+    //the last step of a ramp lands exactly on the target, so that's the published design too
+    if (isBankRamping(band))
+    {
+        auto settings = published.settings[b];
+        settings.freq = bankFreqSmoothers[b].skip(numSamples);
+        settings.gainInDecibels = bankGainSmoothers[b].skip(numSamples);
+        settings.quality = bankQualitySmoothers[b].skip(numSamples);
+        appliedBankBiquads[b] = makeBandBiquad(settings, getProcessingSampleRate());
+    }
+    else
+    {
+        appliedBankBiquads[b] = published.biquads[b];
+    }
+    
+    bankNeedsDesign[b] = false;
+    writeBankBand(band);
+}
+
+void SimpleEQAudioProcessor::advanceBankFades(int numSamples, const BankCoefficients &published) {
+    const auto step = (float) numSamples / (float) elisionFadeSamples;
+    
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        const auto b = (size_t) band;
+        if (! bankBandInCascade[b])
+            continue;
+        
+        auto& weight = bankWeights[b];
+        const auto target = bankTargetWeights[b];
+        
+        //switched off and dry, so it can go once nothing is left ringing in its state
+        if (weight == 0.f && target == 0.f && ! published.active[b])
+        {
+            bankHoldSamples[b] -= numSamples;
+            if (bankHoldSamples[b] <= 0)
+            {
+                removeCascadeBankBand(band);
+                bankBandInCascade[b] = false;
+                bankHoldSamples[b] = 0;
+            }
+            continue;
+        }
+        
+        if (weight != target)
+        {
+            weight = target > weight ? juce::jmin(target, weight + step) : juce::jmax(target, weight - step);
+            
+            //numerator = denominator passes everything through, while the poles let the state die away like it would have
+            if (weight == 0.f && ! published.active[b])
+                bankHoldSamples[b] = getBankHoldSamples(band);
+        }
+        else if (target != 0.f)
+        {
+            continue;
+        }
+        
+        //faded out to change type: the new one starts dry, from where the old one's state is, and fades in
+        if (weight == 0.f && published.active[b])
+        {
+            snapBankSmoothers(band, published.settings[b]);
+            appliedBankTypes[b] = published.settings[b].type;
+            appliedBankBiquads[b] = published.biquads[b];
+            bankTargetWeights[b] = 1.f;
+        }
+        
+        writeBankBand(band);
+    }
+}
+
+void SimpleEQAudioProcessor::finishBankRamps(const BankCoefficients &published) {
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        const auto b = (size_t) band;
+        snapBankSmoothers(band, published.settings[b]);
+        bankNeedsDesign[b] = false;
+        
+        if (! bankBandInCascade[b])
+            continue;
+        
+        if (! published.active[b])
+        {
+            //the state got flushed, there's nothing left to ring out
+            removeCascadeBankBand(band);
+            bankBandInCascade[b] = false;
+            bankWeights[b] = bankTargetWeights[b] = 0.f;
+            bankHoldSamples[b] = 0;
+            continue;
+        }
+        
+        appliedBankTypes[b] = published.settings[b].type;
+        appliedBankBiquads[b] = published.biquads[b];
+        bankWeights[b] = bankTargetWeights[b] = 1.f;
+        bankHoldSamples[b] = 0;
+        writeBankBand(band);
+    }
+}
+
+void SimpleEQAudioProcessor::resetBankSmoothers(double sampleRate, double seconds) {
+    for (size_t band = 0; band < (size_t) maxParametricBands; ++band)
+    {
+        bankFreqSmoothers[band].reset(sampleRate, seconds);
+        bankGainSmoothers[band].reset(sampleRate, seconds);
+        bankQualitySmoothers[band].reset(sampleRate, seconds);
+    }
+}
+
+void SimpleEQAudioProcessor::snapBankSmoothers(int band, const BandSettings &bandSettings) {
+    const auto b = (size_t) band;
+    bankFreqSmoothers[b].setCurrentAndTargetValue(bandSettings.freq);
+    bankGainSmoothers[b].setCurrentAndTargetValue(bandSettings.gainInDecibels);
+    bankQualitySmoothers[b].setCurrentAndTargetValue(bandSettings.quality);
+}
+
+int SimpleEQAudioProcessor::getBankHoldSamples(int band) const {
+    return juce::jmax(1, (int) std::ceil(getDecaySamples(getPoleRadius(appliedBankBiquads[(size_t) band]), ringOutDecibels)));
+}
+
+void SimpleEQAudioProcessor::writeBankBand(int band) {
+    const auto b = (size_t) band;
+    setCascadeBankBand(band, fadeBiquad(appliedBankBiquads[b], bankWeights[b]));
 }
 
-void updateCoefficients(Coefficients &old, const Coefficients &replacements) {
-    //reference objects allocated on the heap so we need to dereference them to get the underlying object
-    *old = *replacements;
+void SimpleEQAudioProcessor::setCascadeBankBand(int band, const BiquadArray& biquad) {
+    if (doublePrecisionActive)
+        doubleCascade.setBankBand(band, biquad);
+    else
+        floatCascade.setBankBand(band, biquad);
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings) {
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    //initialize left chain
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
-   //initialize right chain
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(rightLowCut, lowCutCoefficients, chainSettings.lowCutSlope);
+void SimpleEQAudioProcessor::removeCascadeBankBand(int band) {
+    if (doublePrecisionActive)
+        doubleCascade.removeBankBand(band);
+    else
+        floatCascade.removeBankBand(band);
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings) {
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+void SimpleEQAudioProcessor::setCascadeSVFStage(int slot, const SVFArray& svf, StereoChain chain) {
+    //left/right shares one set of coefficients across every lane, mid/side gives the mid and side lanes their own
+    if (doublePrecisionActive)
+    {
+        if (midSideActive)
+            doubleCascade.setSVFStage(slot, svf, chain);
+        else
+            doubleCascade.setSVFStage(slot, svf);
+    }
+    else
+    {
+        if (midSideActive)
+            floatCascade.setSVFStage(slot, svf, chain);
+        else
+            floatCascade.setSVFStage(slot, svf);
+    }
+}
+
+void SimpleEQAudioProcessor::setCascadeStage(int slot, const BiquadArray& biquad, StereoChain chain) {
+    if (doublePrecisionActive)
+    {
+        if (midSideActive)
+            doubleCascade.setStage(slot, biquad, chain);
+        else
+            doubleCascade.setStage(slot, biquad);
+    }
+    else
+    {
+        if (midSideActive)
+            floatCascade.setStage(slot, biquad, chain);
+        else
+            floatCascade.setStage(slot, biquad);
+    }
+}
+
+void SimpleEQAudioProcessor::setCascadeStageCounts(const ChainSettings& chainSettings) {
+    //mid/side runs as many stages as whichever chain needs more, the other one's extra stages just pass its lane through
+    auto lowCutSlope = (int) chainSettings.lowCutSlope, highCutSlope = (int) chainSettings.highCutSlope;
+    if (midSideActive)
+    {
+        lowCutSlope = juce::jmax(lowCutSlope, (int) sideTargetSettings.lowCutSlope);
+        highCutSlope = juce::jmax(highCutSlope, (int) sideTargetSettings.highCutSlope);
+    }
+    
+    //slope n means n + 1 biquads, and a band that is elided right now doesn't get any
+    const auto numLowCut = bandInKernel[ChainPositions::LowCut] ? lowCutSlope + 1 : 0;
+    const auto numPeak = bandInKernel[ChainPositions::Peak] ? 1 : 0;
+    const auto numHighCut = bandInKernel[ChainPositions::HighCut] ? highCutSlope + 1 : 0;
+    
+    if (doublePrecisionActive)
+        doubleCascade.setStageCounts(numLowCut, numPeak, numHighCut);
+    else
+        floatCascade.setStageCounts(numLowCut, numPeak, numHighCut);
+}
+
+void SimpleEQAudioProcessor::setCascadeSVFRampLength(int numSamples) {
+    if (! stateVariableActive)
+        return;
+    
+    if (doublePrecisionActive)
+        doubleCascade.setSVFRampLength(numSamples);
+    else
+        floatCascade.setSVFRampLength(numSamples);
+}
+
+void SimpleEQAudioProcessor::resetCascadeStages(int firstSlot, int numSlots) {
+    if (doublePrecisionActive)
+        doubleCascade.resetStages(firstSlot, numSlots);
+    else
+        floatCascade.resetStages(firstSlot, numSlots);
+}
+
+bool SimpleEQAudioProcessor::designChangedBands(ChainCoefficients& designed, const ChainSettings& previousSettings,
+                                                const ChainSettings& chainSettings, double sampleRate, bool redesignAll) {
+    bool anythingChanged = false;
+    auto* cache = coefficientCacheEnabled ? &coefficientCache : nullptr;
     
+    if (redesignAll || lowCutSettingsDiffer(chainSettings, previousSettings))
+    {
+        designLowCutBand(designed, chainSettings, sampleRate, cache);
+        ++redesignCounts[ChainPositions::LowCut];
+        anythingChanged = true;
+    }
+    
+    if (redesignAll || peakSettingsDiffer(chainSettings, previousSettings))
+    {
+        designPeakBand(designed, chainSettings, sampleRate, cache);
+        ++redesignCounts[ChainPositions::Peak];
+        anythingChanged = true;
+    }
     
-    //initialize left chain
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    //call new function
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    //initialize right chain
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    //call new functionlo
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
+    if (redesignAll || highCutSettingsDiffer(chainSettings, previousSettings))
+    {
+        designHighCutBand(designed, chainSettings, sampleRate, cache);
+        ++redesignCounts[ChainPositions::HighCut];
+        anythingChanged = true;
+    }
+    
+    designed.settings = chainSettings;
+    return anythingChanged;
+}
+
+bool SimpleEQAudioProcessor::designChangedBankBands(BankCoefficients& designed, const BankSettings& bankSettings,
+                                                    double sampleRate, bool redesignAll) {
+    bool anythingChanged = false;
+    
+    for (size_t band = 0; band < bankSettings.size(); ++band)
+    {
+        if (! redesignAll && ! bandSettingsDiffer(bankSettings[band], designed.settings[band]))
+            continue;
+        
+        designed.biquads[band] = makeBandBiquad(bankSettings[band], sampleRate);
+        designed.active[band] = ! isTransparentBand(bankSettings[band]);
+        ++designed.versions[band];
+        anythingChanged = true;
+    }
+    
+    designed.settings = bankSettings;
+    return anythingChanged;
 }
 
 void SimpleEQAudioProcessor::updateFilters() {
-    auto chainSettings = getChainSettings(apvts);
+    //nothing to design for until the host has told us the sample rate (prepareToPlay designs again anyway)
+    if (getSampleRate() <= 0)
+        return;
+    
+    auto chainSettings = getChainSettings(parameterHandles);
+    auto sampleRate = getProcessingSampleRate();
+    
+    const juce::ScopedLock sl (designLock);
+    
+    //a new sample rate changes every band, otherwise only redesign the bands whose own inputs moved
+    const bool sampleRateChanged = sampleRate != designedSampleRate;
+    const auto mainChanged = designChangedBands(designedCoefficients, designedSettings, chainSettings, sampleRate, sampleRateChanged);
+    
+    //the side chain only gets designed while mid/side is running
+    auto sideChanged = false;
+    if (midSideActive)
+    {
+        const auto sideSettings = getChainSettings(sideParameterHandles);
+        sideChanged = designChangedBands(designedSideCoefficients, designedSideSettings, sideSettings, sampleRate, sampleRateChanged);
+        designedSideSettings = sideSettings;
+    }
+    
+    const auto bankChanged = designChangedBankBands(designedBank, getBankSettings(bankParameterHandles), sampleRate, sampleRateChanged);
+    
+    //the listener fires for gestures that end where they started too, no need to bother the audio thread then
+    if (! mainChanged && ! sideChanged && ! bankChanged)
+        return;
+    
+    designedSettings = chainSettings;
+    designedSampleRate = sampleRate;
+    
+    //the linear phase kernel is built from the same settings
+    if (linearPhaseActive && (mainChanged || bankChanged))
+        linearPhaseKernelWanted.set(true);
+    
+    //publish the finished set in one go
+    if (mainChanged)
+    {
+        coefficientHandoff.getWriteBuffer() = designedCoefficients;
+        coefficientHandoff.publish();
+    }
+    
+    if (sideChanged)
+    {
+        sideCoefficientHandoff.getWriteBuffer() = designedSideCoefficients;
+        sideCoefficientHandoff.publish();
+    }
+    
+    if (bankChanged)
+    {
+        bankHandoff.getWriteBuffer() = designedBank;
+        bankHandoff.publish();
+    }
+    
+    updateTailLength();
+}
+
+void SimpleEQAudioProcessor::updateTailLength() {
+    double seconds = 0;
+    
+    if (linearPhaseActive)
+    {
+        //the symmetric fir keeps going for half its length past the (latency compensated) centre tap
+        seconds = linearPhase.getKernelLength() / 2.0 / getSampleRate();
+    }
+    else if (designedSampleRate > 0)
+    {
+        //the bands run one after the other, so their decay times add up too. elided bands aren't in the path at all
+        //in mid/side the side chain rings on its own, whichever one takes longer sets the tail
+        const auto elide = neutralStageElision.load();
+        double samples = 0, sideSamples = 0;
+        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        {
+            if (elide && isTransparentBand(designedSettings, band) && (! midSideActive || isTransparentBand(designedSideSettings, band)))
+                continue;
+            
+            samples += getBandDecaySamples(designedCoefficients, band, ringOutDecibels);
+            if (midSideActive)
+                sideSamples += getBandDecaySamples(designedSideCoefficients, band, ringOutDecibels);
+        }
+        
+        //the extra bands run on both chains
+        double bankSamples = 0;
+        for (size_t band = 0; band < designedBank.biquads.size(); ++band)
+            if (designedBank.active[band])
+                bankSamples += getDecaySamples(getPoleRadius(designedBank.biquads[band]), ringOutDecibels);
+        
+        seconds = (juce::jmax(samples, sideSamples) + bankSamples) / designedSampleRate;
+    }
+    
+    //rounded up to a tenth of a second so a moving cut doesn't bother the host every time
+    seconds = std::ceil(seconds * 10.0) / 10.0;
+    if (tailLengthSeconds.exchange(seconds) != seconds)
+        tailLengthChanged.set(true);
+}
+
+void SimpleEQAudioProcessor::flushState() {
+    floatCascade.reset();
+    doubleCascade.reset();
+    
+    if (oversampler != nullptr)
+        oversampler->reset();
+    if (doubleOversampler != nullptr)
+        doubleOversampler->reset();
+    
+    if (linearPhaseActive)
+        linearPhase.reset();
+}
+
+void SimpleEQAudioProcessor::splitDualMonoState(int numChannels) {
+    for (int ch = 1; ch < numChannels; ++ch)
+    {
+        if (doublePrecisionActive)
+            doubleCascade.copyChannelState(0, ch);
+        else
+            floatCascade.copyChannelState(0, ch);
+        
+        if (linearPhaseActive)
+            linearPhase.copyChannelState(0, ch);
+    }
+}
+
+void SimpleEQAudioProcessor::finishRamps() {
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        if (isRamping(band))
+            bandNeedsDesign[band] = true;
+    
+    lowCutFreqSmoother.setCurrentAndTargetValue(lowCutFreqSmoother.getTargetValue());
+    highCutFreqSmoother.setCurrentAndTargetValue(highCutFreqSmoother.getTargetValue());
+    peakFreqSmoother.setCurrentAndTargetValue(peakFreqSmoother.getTargetValue());
+    peakGainSmoother.setCurrentAndTargetValue(peakGainSmoother.getTargetValue());
+    peakQualitySmoother.setCurrentAndTargetValue(peakQualitySmoother.getTargetValue());
+    
+    //the state got flushed, there's nothing left for a ringing out band to wait for
+    finishBankRamps(bankHandoff.getReadBuffer());
+}
+
+void SimpleEQAudioProcessor::applyPublishedBands(const ChainCoefficients &published) {
+    //only copy the bands that were actually redesigned. ramping bands get theirs from processSegment,
+    //and pick up the exact published design here once the ramp is over
+    if (! isRamping(ChainPositions::LowCut) && published.versions[ChainPositions::LowCut] != appliedVersions[ChainPositions::LowCut])
+    {
+        updateLowCutFilters(published);
+        appliedVersions[ChainPositions::LowCut] = published.versions[ChainPositions::LowCut];
+    }
+    if (! isRamping(ChainPositions::Peak) && published.versions[ChainPositions::Peak] != appliedVersions[ChainPositions::Peak])
+    {
+        updatePeakFilter(published);
+        appliedVersions[ChainPositions::Peak] = published.versions[ChainPositions::Peak];
+    }
+    if (! isRamping(ChainPositions::HighCut) && published.versions[ChainPositions::HighCut] != appliedVersions[ChainPositions::HighCut])
+    {
+        updateHighCutFilters(published);
+        appliedVersions[ChainPositions::HighCut] = published.versions[ChainPositions::HighCut];
+    }
+}
+
+void SimpleEQAudioProcessor::resetSmoothers(const ChainSettings &chainSettings) {
+    lowCutFreqSmoother.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreqSmoother.setCurrentAndTargetValue(chainSettings.highCutFreq);
+    peakFreqSmoother.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakGainSmoother.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+    peakQualitySmoother.setCurrentAndTargetValue(chainSettings.peakQuality);
+    
+    targetSettings = chainSettings;
+    bandNeedsDesign.fill(false);
+    
+    //bands that start out transparent start out of the path, no fade
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        const auto transparent = isBandTransparent(band);
+        bandWeights[band] = bandTargetWeights[band] = transparent ? 0.f : 1.f;
+        bandInKernel[band] = ! transparent;
+    }
     
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    //pick the kernel built for exactly the stages these slopes use
+    setCascadeStageCounts(targetSettings);
+}
+
+bool SimpleEQAudioProcessor::isBandTransparent(ChainPositions band) const {
+    //anything still ramping (or waiting on a timestamped design) stays in
+    if (! neutralStageElision.load(std::memory_order_relaxed) || needsDesign(band))
+        return false;
+    
+    //in mid/side the band has to be doing nothing in both chains
+    return isTransparentBand(targetSettings, band) && (! midSideActive || isTransparentBand(sideTargetSettings, band));
+}
+
+bool SimpleEQAudioProcessor::isElisionMoving() const {
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        //still fading, or faded out and waiting to be dropped
+        if (bandWeights[band] != bandTargetWeights[band] || (bandInKernel[band] && bandTargetWeights[band] == 0.f))
+            return true;
+    }
+    return false;
+}
+
+bool SimpleEQAudioProcessor::isCascadeMoving() const {
+    return needsDesign(ChainPositions::LowCut) || needsDesign(ChainPositions::Peak) || needsDesign(ChainPositions::HighCut)
+        || isElisionMoving() || isBankMoving();
+}
+
+void SimpleEQAudioProcessor::updateElision() {
+    auto layoutChanged = false;
+    
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        const auto target = isBandTransparent(band) ? 0.f : 1.f;
+        if (target == bandTargetWeights[band])
+            continue;
+        
+        bandTargetWeights[band] = target;
+        
+        //coming back from being elided: forget whatever the band held when it left and start it off fully dry
+        if (! bandInKernel[band])
+        {
+            switch (band) {
+                case LowCut:
+                    resetCascadeStages(lowCutSlot, maxCutStages);
+                    resetCascadeStages(extraLowCutSlot, numExtraCutSections);
+                    break;
+                case Peak: resetCascadeStages(peakSlot, 1); break;
+                case HighCut:
+                    resetCascadeStages(highCutSlot, maxCutStages);
+                    resetCascadeStages(extraHighCutSlot, numExtraCutSections);
+                    break;
+            }
+            
+            bandInKernel[band] = true;
+            rewriteBand(band);
+            layoutChanged = true;
+        }
+    }
+    
+    if (layoutChanged)
+        setCascadeStageCounts(targetSettings);
+}
+
+void SimpleEQAudioProcessor::advanceElision(int numSamples) {
+    const auto step = (float) numSamples / (float) elisionFadeSamples;
+    auto layoutChanged = false;
+    
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        auto& weight = bandWeights[band];
+        const auto target = bandTargetWeights[band];
+        
+        //fully dry, so the band can go once nothing is left ringing in its state
+        if (bandInKernel[band] && weight == 0.f && target == 0.f)
+        {
+            bandHoldSamples[band] -= numSamples;
+            if (bandHoldSamples[band] <= 0)
+            {
+                bandInKernel[band] = false;
+                layoutChanged = true;
+            }
+            continue;
+        }
+        
+        if (weight == target)
+            continue;
+        
+        weight = target > weight ? juce::jmin(target, weight + step) : juce::jmax(target, weight - step);
+        rewriteBand(band);
+        
+        //the svf's state never reaches its output at weight 0, a biquad's keeps coming through its poles for a while
+        if (weight == 0.f && ! stateVariableActive)
+        {
+            auto decaySamples = getBandDecaySamples(appliedCoefficients[MainChain], band, ringOutDecibels);
+            if (midSideActive)
+                decaySamples = juce::jmax(decaySamples, getBandDecaySamples(appliedCoefficients[SideChain], band, ringOutDecibels));
+            bandHoldSamples[band] = (int) std::ceil(decaySamples);
+        }
+        else if (weight == 0.f)
+        {
+            bandHoldSamples[band] = 0;
+        }
+    }
+    
+    if (layoutChanged)
+        setCascadeStageCounts(targetSettings);
+}
+
+bool SimpleEQAudioProcessor::isRamping(ChainPositions band) const {
+    switch (band) {
+        case LowCut: return lowCutFreqSmoother.isSmoothing();
+        case Peak: return peakFreqSmoother.isSmoothing() || peakGainSmoother.isSmoothing() || peakQualitySmoother.isSmoothing();
+        case HighCut: return highCutFreqSmoother.isSmoothing();
+    }
+    return false;
+}
+
+void SimpleEQAudioProcessor::startRampTowards(const ChainCoefficients &target) {
+    //only retarget the bands the message thread redesigned, the others might be following timestamped automation
+    //with smoothing off (or nothing moved) these finish straight away and the published design gets copied below
+    if (target.versions[ChainPositions::LowCut] != appliedVersions[ChainPositions::LowCut])
+    {
+        lowCutFreqSmoother.setTargetValue(target.settings.lowCutFreq);
+        targetSettings.lowCutFreq = target.settings.lowCutFreq;
+        targetSettings.lowCutSlope = target.settings.lowCutSlope;
+        bandNeedsDesign[ChainPositions::LowCut] = bandNeedsDesign[ChainPositions::LowCut] || isRamping(ChainPositions::LowCut);
+    }
+    
+    if (target.versions[ChainPositions::Peak] != appliedVersions[ChainPositions::Peak])
+    {
+        peakFreqSmoother.setTargetValue(target.settings.peakFreq);
+        peakGainSmoother.setTargetValue(target.settings.peakGainInDecibels);
+        peakQualitySmoother.setTargetValue(target.settings.peakQuality);
+        targetSettings.peakFreq = target.settings.peakFreq;
+        targetSettings.peakGainInDecibels = target.settings.peakGainInDecibels;
+        targetSettings.peakQuality = target.settings.peakQuality;
+        bandNeedsDesign[ChainPositions::Peak] = bandNeedsDesign[ChainPositions::Peak] || isRamping(ChainPositions::Peak);
+    }
+    
+    if (target.versions[ChainPositions::HighCut] != appliedVersions[ChainPositions::HighCut])
+    {
+        highCutFreqSmoother.setTargetValue(target.settings.highCutFreq);
+        targetSettings.highCutFreq = target.settings.highCutFreq;
+        targetSettings.highCutSlope = target.settings.highCutSlope;
+        bandNeedsDesign[ChainPositions::HighCut] = bandNeedsDesign[ChainPositions::HighCut] || isRamping(ChainPositions::HighCut);
+    }
+    
+    //slopes don't ramp, the kernel has to match the new stage count right away
+    setCascadeStageCounts(targetSettings);
+    
+    applyPublishedBands(target);
+}
+
+void SimpleEQAudioProcessor::applyParameterEvent(const ParameterEvent &event) {
+    switch (event.parameter) {
+        case LowCutFreqParam:
+            targetSettings.lowCutFreq = event.value;
+            lowCutFreqSmoother.setTargetValue(event.value);
+            bandNeedsDesign[ChainPositions::LowCut] = true;
+            break;
+        case HighCutFreqParam:
+            targetSettings.highCutFreq = event.value;
+            highCutFreqSmoother.setTargetValue(event.value);
+            bandNeedsDesign[ChainPositions::HighCut] = true;
+            break;
+        case PeakFreqParam:
+            targetSettings.peakFreq = event.value;
+            peakFreqSmoother.setTargetValue(event.value);
+            bandNeedsDesign[ChainPositions::Peak] = true;
+            break;
+        case PeakGainParam:
+            targetSettings.peakGainInDecibels = event.value;
+            peakGainSmoother.setTargetValue(event.value);
+            bandNeedsDesign[ChainPositions::Peak] = true;
+            break;
+        case PeakQualityParam:
+            targetSettings.peakQuality = event.value;
+            peakQualitySmoother.setTargetValue(event.value);
+            bandNeedsDesign[ChainPositions::Peak] = true;
+            break;
+        //a slope is two parameters, the other half comes from wherever the apvts has it now
+        case LowCutSlopeParam:
+            targetSettings.lowCutSlope = combineSlopes(event.value, parameterHandles.load<LowCutSteepSlopeParam>());
+            bandNeedsDesign[ChainPositions::LowCut] = true;
+            break;
+        case HighCutSlopeParam:
+            targetSettings.highCutSlope = combineSlopes(event.value, parameterHandles.load<HighCutSteepSlopeParam>());
+            bandNeedsDesign[ChainPositions::HighCut] = true;
+            break;
+        case LowCutSteepSlopeParam:
+            targetSettings.lowCutSlope = combineSlopes(parameterHandles.load<LowCutSlopeParam>(), event.value);
+            bandNeedsDesign[ChainPositions::LowCut] = true;
+            break;
+        case HighCutSteepSlopeParam:
+            targetSettings.highCutSlope = combineSlopes(parameterHandles.load<HighCutSlopeParam>(), event.value);
+            bandNeedsDesign[ChainPositions::HighCut] = true;
+            break;
+        default:
+            jassertfalse;
+            break;
+    }
+    
+    setCascadeStageCounts(targetSettings);
+}
+
+void SimpleEQAudioProcessor::processSegment(int startSample, int numSamples, size_t numGroups) {
+    //a timestamped change might have just made a band transparent, or brought one back
+    updateElision();
+    
+    //nothing moving, the whole segment runs on the coefficients we already have
+    if (! isCascadeMoving())
+    {
+        runCascade(startSample, numSamples, numGroups);
+        return;
+    }
+    
+    const auto& published = coefficientHandoff.getReadBuffer();
+    const auto& publishedBank = bankHandoff.getReadBuffer();
+    const auto sampleRate = getProcessingSampleRate();
+    const auto interval = juce::jmax(1, smoothingUpdateInterval.load());
+    const auto endSample = startSample + numSamples;
+    
+    //slopes don't ramp, the designs in here always use the targets
+    auto settings = targetSettings;
+    rampCoefficients.lowCutSlope = settings.lowCutSlope;
+    rampCoefficients.highCutSlope = settings.highCutSlope;
+    //the svf engine only needs the settings, the update calls design from those.
+    //these are designed exactly, not through the coefficient cache: its keys round to the parameter steps,
+    //and a ramp rounded to 0.5db or 0.05 q would put back the stair steps the smoothing is there to remove
+    const auto designBiquads = ! stateVariableActive;
+    
+    for (int start = startSample; start < endSample; )
+    {
+        //cells run from one multiple of the interval to the next on our own sample clock. a ramping band gets designed once per
+        //cell, for where it will be at the end of the cell, and that design carries on into the next block when the host's
+        //block ends halfway through one. so where the host splits its blocks never changes the coefficients we run
+        const auto intoInterval = (int) ((samplePosition * oversamplingFactor + start) % interval);
+        const auto cellRemaining = interval - intoInterval;
+        const auto num = juce::jmin(cellRemaining, endSample - start);
+        const auto atGridPoint = intoInterval == 0;
+        
+        //a band a timestamped change (or a new ramp) just asked for gets its design straight away, for the rest of the cell
+        auto designsNow = [&](ChainPositions band) { return bandNeedsDesign[band] || (atGridPoint && isRamping(band)); };
+        auto designed = false;
+        
+        if (designsNow(ChainPositions::LowCut))
+        {
+            settings.lowCutFreq = lowCutFreqSmoother.skip(cellRemaining);
+            rampCoefficients.settings = settings;
+            if (designBiquads)
+                makeLowCutBiquads(rampCoefficients.lowCut, settings, sampleRate);
+            updateLowCutFilters(rampCoefficients);
+            bandNeedsDesign[ChainPositions::LowCut] = false;
+            loadMeter.addDesign();
+            designed = true;
+        }
+        
+        if (designsNow(ChainPositions::Peak))
+        {
+            settings.peakFreq = peakFreqSmoother.skip(cellRemaining);
+            settings.peakGainInDecibels = peakGainSmoother.skip(cellRemaining);
+            settings.peakQuality = peakQualitySmoother.skip(cellRemaining);
+            rampCoefficients.settings = settings;
+            if (designBiquads)
+                rampCoefficients.peak = makePeakBiquad(settings, sampleRate);
+            updatePeakFilter(rampCoefficients);
+            bandNeedsDesign[ChainPositions::Peak] = false;
+            loadMeter.addDesign();
+            designed = true;
+        }
+        
+        if (designsNow(ChainPositions::HighCut))
+        {
+            settings.highCutFreq = highCutFreqSmoother.skip(cellRemaining);
+            rampCoefficients.settings = settings;
+            if (designBiquads)
+                makeHighCutBiquads(rampCoefficients.highCut, settings, sampleRate);
+            updateHighCutFilters(rampCoefficients);
+            bandNeedsDesign[ChainPositions::HighCut] = false;
+            loadMeter.addDesign();
+            designed = true;
+        }
+        
+        //the extra bands ramp on the same grid
+        for (int band = 0; band < maxParametricBands; ++band)
+        {
+            if (bankNeedsDesign[(size_t) band] || (atGridPoint && isBankRamping(band)))
+            {
+                designBankBand(band, cellRemaining, publishedBank);
+                loadMeter.addDesign();
+            }
+        }
+        
+        //any band that just reached a published target snaps to the exact published design
+        applyPublishedBands(published);
+        
+        //bands fading in or out of the path take one step per cell, on the grid like the designs
+        if (atGridPoint)
+        {
+            advanceElision(interval);
+            advanceBankFades(interval, publishedBank);
+        }
+        
+        //the svf glides to whatever just got written over the rest of the cell, not just the part of it in this block
+        if (atGridPoint || designed)
+            setCascadeSVFRampLength(cellRemaining);
+        
+        runCascade(start, num, numGroups);
+        start += num;
+        
+        //a ramp that just finished might have landed on something transparent
+        updateElision();
+    }
+}
+
+void SimpleEQAudioProcessor::runCascade(int startSample, int numSamples, size_t numGroups) {
+    if (doublePrecisionActive)
+        doubleCascade.process(startSample, numSamples, numGroups);
+    else
+        floatCascade.process(startSample, numSamples, numGroups);
+}
+
+bool SimpleEQAudioProcessor::pushParameterChange(juce::int64 position, ChainParameter parameter, float value) {
+    return parameterEvents.push({ position, parameter, value });
+}
+
+void SimpleEQAudioProcessor::setSmoothing(double rampSeconds, int updateIntervalSamples) {
+    //picked up by the audio thread at the start of the next block
+    smoothingSeconds = juce::jmax(0.0, rampSeconds);
+    smoothingUpdateInterval = juce::jmax(1, updateIntervalSamples);
+}
+
+void SimpleEQAudioProcessor::setCoefficientCacheEnabled(bool shouldBeEnabled) {
+    const juce::ScopedLock sl (designLock);
+    coefficientCacheEnabled = shouldBeEnabled;
+    
+    //don't keep memory warm for something we're not using
+    if (! shouldBeEnabled)
+        coefficientCache.clear();
+}
+
+DSPLoadMeter::Stats SimpleEQAudioProcessor::getLoadStats() const {
+    auto stats = loadMeter.getStats();
+    for (int band = 0; band < (int) stats.redesignCounts.size(); ++band)
+        stats.redesignCounts[(size_t) band] = getRedesignCount(static_cast<ChainPositions>(band));
+    return stats;
+}
+
+void SimpleEQAudioProcessor::parameterValueChanged(int parameterIndex, float newValue) {
+    //this can be called from the audio thread, so just set the flag and let the timer do the work
+    parametersChanged.set(true);
+}
+
+void SimpleEQAudioProcessor::timerCallback() {
+    //a new oversampling or phase setting reallocates everything and changes our latency, so the audio thread
+    //gets held off while we prepare again (that designs the filters too)
+    if (getSampleRate() > 0 && processingSettingsChanged())
+    {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+        return;
+    }
+    
+    //only redesign when something actually changed
+    if (parametersChanged.compareAndSetBool(false, true))
+        updateFilters();
+    
+    //one kernel job at a time, and only once the convolver has finished fading to the last one
+    if (linearPhaseActive && linearPhaseKernelWanted.get() && ! linearPhaseKernelJobRunning.get() && linearPhase.isReadyForKernel())
+        startLinearPhaseKernelJob();
+    
+    //juce has no flag just for the tail, the wrappers get the host to read latency and tail again from this one
+    if (tailLengthChanged.compareAndSetBool(false, true))
+        updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withLatencyChanged(true));
+}
+
+bool SimpleEQAudioProcessor::processingSettingsChanged() const {
+    return getOversamplingChoice() != preparedOversampling || getOversamplingFilterChoice() != preparedOversamplingFilter
+        || getPhaseModeChoice() != preparedPhaseMode || getLinearPhaseFftSizeChoice() != preparedLinearPhaseFftSize
+        || getFilterEngineChoice() != preparedFilterEngine || getStereoModeChoice() != preparedStereoMode;
+}
+
+void SimpleEQAudioProcessor::prepareLinearPhase() {
+    //fft sizes 256 to 4096, each partition is half of that
+    const auto partitionSize = 128 << preparedLinearPhaseFftSize;
+    //about a quarter of a second of taps, enough to resolve a steep low cut at 20hz
+    const auto kernelLength = juce::jmax(partitionSize * 2, juce::nextPowerOfTwo(juce::roundToInt(getSampleRate() / 4.0)));
+    
+    linearPhase.prepare(numPreparedChannels, partitionSize, kernelLength);
+    
+    //the audio thread isn't running, so the first kernel goes in straight away
+    linearPhaseKernelWanted.set(false);
+    designLinearPhaseKernel(getChainSettings(parameterHandles), getBankSettings(bankParameterHandles));
+}
+
+void SimpleEQAudioProcessor::startLinearPhaseKernelJob() {
+    //the job gets its own copy of the settings
+    linearPhaseKernelWanted.set(false);
+    linearPhaseKernelJobRunning.set(true);
+    
+    kernelThread.addJob([this, chainSettings = getChainSettings(parameterHandles), bankSettings = getBankSettings(bankParameterHandles)]
+    {
+        designLinearPhaseKernel(chainSettings, bankSettings);
+        linearPhaseKernelJobRunning.set(false);
+    });
+}
+
+void SimpleEQAudioProcessor::designLinearPhaseKernel(const ChainSettings& chainSettings, const BankSettings& bankSettings) {
+    makeLinearPhaseImpulse(linearPhaseImpulse, chainSettings, bankSettings, getSampleRate(), linearPhase.getKernelLength());
+    linearPhase.setKernel(linearPhaseImpulse.data());
+}
+
+void SimpleEQAudioProcessor::prepareOversampling(int samplesPerBlock) {
+    preparedOversampling = getOversamplingChoice();
+    preparedOversamplingFilter = getOversamplingFilterChoice();
+    
+    //choice 1 is 2x, 2 is 4x. the linear phase fir always runs at the host rate
+    oversamplingFactor = linearPhaseActive ? 1 : 1 << preparedOversampling;
+    
+    oversampler.reset();
+    doubleOversampler.reset();
+    
+    if (oversamplingFactor == 1)
+        return;
+    
+    //polyphase iir is cheap and low latency but not linear phase, the fir is linear phase but costs more and adds more latency.
+    //the hq versions have steeper, flatter half band filters for more cpu
+    const auto useFir = preparedOversamplingFilter >= 2;
+    const auto maxQuality = preparedOversamplingFilter % 2 == 1;
+    
+    //only the one for the precision the host renders in
+    auto makeOversampler = [&](auto& target)
+    {
+        using OversamplingType = typename std::decay_t<decltype(target)>::element_type;
+        //integer latency so what we report to the host is exactly what we add
+        target = std::make_unique<OversamplingType>((size_t) numPreparedChannels, (size_t) preparedOversampling,
+                                                    useFir ? OversamplingType::filterHalfBandFIREquiripple : OversamplingType::filterHalfBandPolyphaseIIR,
+                                                    maxQuality, true);
+        target->initProcessing((size_t) samplesPerBlock);
+    };
+    
+    if (doublePrecisionActive)
+        makeOversampler(doubleOversampler);
+    else
+        makeOversampler(oversampler);
 }
 
 //declaring createParameterLayout
@@ -544,6 +2186,11 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
         stringArray.add(str);
     }
     
+    //the steeper slopes are separate parameters so the ones above keep the mapping hosts already automate
+    juce::StringArray steepStringArray { "Off" };
+    for (int i = 1; i <= numSteepSlopes; ++i)
+        steepStringArray.add(juce::String(48 + 12 * i) + "db/Oct");
+    
     //create audioparameter that intakes string of choices
     //uses default value 0 so the filter will have a slope of 12db/Oct
     //LOWCUT SLOPE
@@ -551,6 +2198,82 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     
     //HIGHCUT SLOPE
     layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HighCut Slope", 1), "HighCut Slope", stringArray, 0));
+    
+    //STEEP SLOPES
+    //60 to 96 db/Oct, Off leaves the slope above in charge
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("LowCut Steep Slope", 1), "LowCut Steep Slope", steepStringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("HighCut Steep Slope", 1), "HighCut Steep Slope", steepStringArray, 0));
+    
+    //OVERSAMPLING
+    //runs the whole chain at 2x or 4x so the peak and high cut keep their analog shape near nyquist
+    //changing it changes our latency, so it isn't automatable
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Oversampling", 1), "Oversampling",
+                                                            juce::StringArray { "Off", "2x", "4x" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Oversampling Filter", 1), "Oversampling Filter",
+                                                            juce::StringArray { "Polyphase IIR", "Polyphase IIR HQ", "Linear Phase FIR", "Linear Phase FIR HQ" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    //FILTER ENGINE
+    //same responses either way. the state variable (tpt) filters cost a little more per sample but glide smoothly
+    //through every sample of a ramp instead of stepping, so heavily automated moves don't zipper
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Filter Engine", 1), "Filter Engine",
+                                                            juce::StringArray { "Biquad", "State Variable" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    //PHASE MODE
+    //linear phase swaps the iir cascade for one long symmetric fir with the same magnitude, for mastering.
+    //the fft size trades cpu for latency: bigger partitions are cheaper per sample but add more delay
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Phase Mode", 1), "Phase Mode",
+                                                            juce::StringArray { "Minimum Phase", "Linear Phase" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Linear Phase FFT Size", 1), "Linear Phase FFT Size",
+                                                            juce::StringArray { "256", "512", "1024", "2048", "4096" }, 2,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    //STEREO MODE
+    //mid/side runs the parameters above on the mid channel and the side copies below on the side channel
+    //(stereo tracks in minimum phase mode only). everything else stays left/right with one set of settings
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Stereo Mode", 1), "Stereo Mode",
+                                                            juce::StringArray { "Stereo", "Mid/Side" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    //SIDE CHANNEL
+    //same ranges and defaults as the main set, so the side starts out untouched
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side LowCut Freq", 1), "Side LowCut Freq",
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side HighCut Freq", 1), "Side HighCut Freq",
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Peak Freq", 1), "Side Peak Freq",
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 750.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Peak Gain", 1), "Side Peak Gain",
+                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 0.5f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Side Peak Quality", 1), "Side Peak Quality",
+                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Side LowCut Slope", 1), "Side LowCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Side HighCut Slope", 1), "Side HighCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Side LowCut Steep Slope", 1), "Side LowCut Steep Slope", steepStringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("Side HighCut Steep Slope", 1), "Side HighCut Steep Slope", steepStringArray, 0));
+    
+    //EXTRA BANDS
+    //maxParametricBands single biquad bands after the fixed ones. they all start off, and only the ones that are
+    //switched on cost anything. default frequencies are spread across the range so a band shows up somewhere useful
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        auto id = [band](BandParameter param) { return BankParameterHandles::getParameterID(band, param); };
+        const auto defaultFreq = (float) juce::roundToInt(juce::mapToLog10((band + 0.5f) / maxParametricBands, 20.f, 20000.f));
+        
+        layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID(id(BandTypeParam), 1), id(BandTypeParam),
+                                                                juce::StringArray { "Off", "Peak", "Low Shelf", "High Shelf", "Notch" }, 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id(BandFreqParam), 1), id(BandFreqParam),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), defaultFreq));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id(BandGainParam), 1), id(BandGainParam),
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 0.5f), 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id(BandQualityParam), 1), id(BandQualityParam),
+                                                               juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+    }
      
     return layout;
 }
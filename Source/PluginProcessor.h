@@ -9,15 +9,33 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "TripleBuffer.h"
+#include "FilterCascade.h"
+#include "CoefficientCache.h"
+#include "BiquadDesign.h"
+#include "ParameterEventQueue.h"
+#include "FrequencyResponse.h"
+#include "SpectrumAnalyzer.h"
+#include "LinearPhaseConvolver.h"
+#include "DSPLoadMeter.h"
 
 //cant use numbers to begin identifiers in c++ so have to put Slope before that
 enum Slope {
     Slope_12,
     Slope_24,
     Slope_36,
-    Slope_48
+    Slope_48,
+    Slope_60,
+    Slope_72,
+    Slope_84,
+    Slope_96
 };
 
+//the slope parameters keep the 12 to 48 db/Oct choices they shipped with, so automation written against them still lands
+//on the same slopes. the steep ones add 60 to 96 on top of that: anything but Off there wins over the regular choice
+static constexpr int numSteepSlopes = Slope_96 - Slope_48;
+Slope combineSlopes(float slopeChoice, float steepSlopeChoice);
+
 // extract parameters from audio processor value tree state (create data structure to represent all values)
 struct ChainSettings {
     float peakFreq {0}, peakGainInDecibels {0}, peakQuality {1.f};
@@ -29,18 +47,87 @@ struct ChainSettings {
 
 // helper function that will give all parameter values in data struct
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-// create a filer alias (peakfilter)
-using Filter = juce::dsp::IIR::Filter<float>;
-// since we are going between [12,24,36,48] db/Oct, we need 4 of these filters
-// for dsp in JUCE:
-// 1. define a Chain 2. pass in a Processing Context, which will run through each element of the chian automatically
-// we can put 4 of these filters in a single processor chain, which will allow us to pass a single context and allow us to process all of the audio automatically
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-// if we configure as LOWPASS/HIGHPASS filter, it will have a default 12db slope
-
-//can represent parametric filter too
-//need 2 instances of MonoChain if we want to do stereo processing
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+//every parameter the chain reads, used to index the handle table below
+enum ChainParameter {
+    LowCutFreqParam,
+    HighCutFreqParam,
+    PeakFreqParam,
+    PeakGainParam,
+    PeakQualityParam,
+    LowCutSlopeParam,
+    HighCutSlopeParam,
+    LowCutSteepSlopeParam,
+    HighCutSteepSlopeParam,
+    NumChainParameters
+};
+
+//looking a parameter up by its string id is a search every time, so do it once up front and keep the raw atomics
+struct ChainParameterHandles {
+    //idPrefix picks another copy of the same parameters, eg "Side " for the side channel in mid/side mode
+    explicit ChainParameterHandles(juce::AudioProcessorValueTreeState& apvts, const juce::String& idPrefix = {});
+    
+    //the index is a template argument so a bad one fails to compile instead of reading past the table
+    template <ChainParameter Param>
+    float load() const noexcept {
+        static_assert(Param >= 0 && Param < NumChainParameters, "not a chain parameter");
+        return handles[Param]->load(std::memory_order_relaxed);
+    }
+    
+    //the apvts id for each entry of the table
+    static const char* getParameterID(ChainParameter param);
+    
+private:
+    std::array<std::atomic<float>*, NumChainParameters> handles {};
+};
+
+//same as above but just a handful of atomic reads
+ChainSettings getChainSettings(const ChainParameterHandles& handles);
+
+//the extra bands that go on top of the low cut / peak / high cut, each one a single biquad of its own type.
+//the cascade sizes its bank at runtime, this is just how many the parameter layout declares
+static constexpr int maxParametricBands = 16;
+
+enum BandType {
+    Band_Off,
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch
+};
+
+struct BandSettings {
+    BandType type {Band_Off};
+    float freq {1000.f}, gainInDecibels {0}, quality {1.f};
+};
+
+using BankSettings = std::array<BandSettings, maxParametricBands>;
+
+//the four parameters every extra band has
+enum BandParameter {
+    BandTypeParam,
+    BandFreqParam,
+    BandGainParam,
+    BandQualityParam,
+    NumBandParameters
+};
+
+//same as ChainParameterHandles for "Band 1 Type" ... "Band 16 Quality"
+struct BankParameterHandles {
+    explicit BankParameterHandles(juce::AudioProcessorValueTreeState& apvts);
+    
+    float load(int band, BandParameter param) const noexcept {
+        return handles[(size_t) band][(size_t) param]->load(std::memory_order_relaxed);
+    }
+    
+    //band counts from 0 here, the ids count from 1
+    static juce::String getParameterID(int band, BandParameter param);
+    
+private:
+    std::array<std::array<std::atomic<float>*, NumBandParameters>, maxParametricBands> handles {};
+};
+
+BankSettings getBankSettings(const BankParameterHandles& handles);
 
 //define an enum to return an index
 enum ChainPositions {
@@ -49,146 +136,95 @@ enum ChainPositions {
     HighCut
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-//& because it allows you to modify the original object, const because you cant make changes to the replacement
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+//in mid/side mode the main parameters set the mid channel and the "Side " copies set the side channel.
+//also the lane each one runs in
+enum StereoChain {
+    MainChain,
+    SideChain
+};
 
-//makes a peak filter from chain settings and sample rate
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+//plain copy of every biquad the chain needs. it gets designed off the audio thread and handed over through a TripleBuffer,
+//so the audio thread never has to allocate a new Coefficients object
+struct ChainCoefficients {
+    //juce stores a biquad as b0, b1, b2, a1, a2 (already divided through by a0)
+    using Biquad = BiquadArray;
+    Biquad peak {};
+    std::array<Biquad, maxCutSections> lowCut {}, highCut {};
+    Slope lowCutSlope {Slope::Slope_12}, highCutSlope {Slope::Slope_12};
+    //bumped every time a band gets redesigned (indexed by ChainPositions), so the audio thread only copies the bands that changed
+    std::array<juce::uint32, 3> versions {};
+    //what it was designed from, so the audio thread knows where to ramp to
+    ChainSettings settings;
+};
 
-//made update Cut filter functions public
-template <int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients) {
-    //update the coefficients
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    //set bypass to false
-    chain.template setBypassed<Index>(false);
-    
-    
-    
-}
+//the extra bands' designs, handed to the audio thread the same way
+struct BankCoefficients {
+    std::array<BiquadArray, maxParametricBands> biquads {};
+    //bands that are off or flat aren't worth running, the cascade packs them out
+    std::array<bool, maxParametricBands> active {};
+    std::array<juce::uint32, maxParametricBands> versions {};
+    BankSettings settings {};
+};
 
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain,
-                     const CoefficientType& coefficients,
-                     const Slope& slope)
-                     //const ChainSettings& chainSettings)
-{
-    //cut coefficients using helper function
-    //for order we have to do lowCutSlope + 1 * 2, since adding 1 and doubling will give us an order of 2,4,6, or 8
-    //std::cout << juce::String("sampleRate :") << juce::String(getSampleRate()) << std::endl;
-    //auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-    //                                                                                                   getSampleRate(),
-    //                                                                                                   2 * (chainSettings.lowCutSlope + 1));
-    
-    
-    //initialize left chain
-    //auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    
-    // (bypass all links in left chain) there are 4 positions
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-    
-    //cleaning up switch statement below
-    
-    //use enum to display slope setting since enums decay to integers (which is what our choice parameter is expressed in)
-    switch (slope){
-        case Slope_48: {
-            update<3>(chain, coefficients);
-            //chain.template setBypassed<3>(false);
-            //leftLowCut.template setBypassed<3>(false);
-        }
-        case Slope_36: {
-            update<2>(chain, coefficients);
-            //chain.template setBypassed<2>(false);
-            //leftLowCut.template setBypassed<2>(false);
-        }
-        case Slope_24: {
-            update<1>(chain, coefficients);
-            //chain.template setBypassed<1>(false);
-            //leftLowCut.template setBypassed<1>(false);
-        }
-        case Slope_12: {
-            update<0>(chain, coefficients);
-            //chain.template setBypassed<0>(false);
-            //leftLowCut.template setBypassed<0>(false);
-        }
-            
-            
-            /*
-            
-            //if order is 2 = 12bc/oct slope, the helper function will return an array with 1 coefficient object only
-            //assign coefficients to first filter in cut filter chain and also stop bypassing that filter chain
-        case Slope_12:
-        {
-            //dereference left
-            *leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-            //stop bypassing particular left chain
-            leftLowCut.template setBypassed<0>(false);
-            break;
-        }
-            //now will assign to the first 2 links in the filter chain and stop by passing them
-        case Slope_24:
-        {
-            *leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.template setBypassed<0>(false);
-            *leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.template setBypassed<1>(false);
-            break;
-        }
-            //now will assign to the first 3 links in the filter chain and stop by passing them
-        case Slope_36:
-        {
-            *leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.template setBypassed<0>(false);
-            *leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.template setBypassed<1>(false);
-            *leftLowCut.template get<2>().coefficients = *cutCoefficients[2];
-            leftLowCut.template setBypassed<2>(false);
-            break;
-        }
-            //now will assign to the first 4 links in the filter chain and stop by passing them
-        case Slope_48:
-        {
-            *leftLowCut.template get<0>().coefficients = *cutCoefficients[0];
-            leftLowCut.template setBypassed<0>(false);
-            *leftLowCut.template get<1>().coefficients = *cutCoefficients[1];
-            leftLowCut.template setBypassed<1>(false);
-            *leftLowCut.template get<2>().coefficients = *cutCoefficients[2];
-            leftLowCut.template setBypassed<2>(false);
-            *leftLowCut.template get<3>().coefficients = *cutCoefficients[3];
-            leftLowCut.template setBypassed<3>(false);
-            break;
-        }
-             */
-    }
-             
-    
-    
-}
+//room for every biquad the chain and the bank can have at once, for the response curve and the linear phase kernel
+static constexpr int maxResponseBiquads = maxCascadeStages + maxParametricBands;
+
+//allocation free designs straight from the settings, these are fine to call on the audio thread
+ChainCoefficients::Biquad makePeakBiquad(const ChainSettings& chainSettings, double sampleRate);
+void makeLowCutBiquads(std::array<ChainCoefficients::Biquad, maxCutSections>& biquads, const ChainSettings& chainSettings, double sampleRate);
+void makeHighCutBiquads(std::array<ChainCoefficients::Biquad, maxCutSections>& biquads, const ChainSettings& chainSettings, double sampleRate);
+
+//the same bands as trapezoidal state variable filters, for the svf engine. one tan per stage, no other trig
+SVFArray makePeakSVF(const ChainSettings& chainSettings, double sampleRate);
+void makeLowCutSVFs(std::array<SVFArray, maxCutSections>& svfs, const ChainSettings& chainSettings, double sampleRate);
+void makeHighCutSVFs(std::array<SVFArray, maxCutSections>& svfs, const ChainSettings& chainSettings, double sampleRate);
+
+//designs every band for the given settings
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+//copies out just the biquads the slopes actually use (low cuts, peak, high cuts) and returns how many,
+//which is what FrequencyResponse::evaluate wants
+int getActiveBiquads(const ChainCoefficients& chainCoefficients, std::array<BiquadArray, maxResponseBiquads>& biquads);
+
+//one extra band's biquad (a straight wire for Band_Off)
+BiquadArray makeBandBiquad(const BandSettings& bandSettings, double sampleRate);
+BankCoefficients makeBankCoefficients(const BankSettings& bankSettings, double sampleRate);
+//copies the active bands' biquads to biquads (eg straight after getActiveBiquads' ones) and returns how many
+int getActiveBankBiquads(const BankCoefficients& bankCoefficients, BiquadArray* biquads);
+
+//same thing one band at a time, so a band can be redesigned without touching the others
+//pass a cache to reuse designs for settings that were seen recently
+void designLowCutBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache = nullptr);
+void designPeakBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache = nullptr);
+void designHighCutBand(ChainCoefficients& chainCoefficients, const ChainSettings& chainSettings, double sampleRate, CoefficientCache* cache = nullptr);
+
+//a linear phase fir with the same magnitude response as the chain: length taps (the first one is always 0),
+//symmetric around length / 2. allocates, so keep it off the audio thread
+void makeLinearPhaseImpulse(std::vector<float>& impulse, const ChainSettings& chainSettings, const BankSettings& bankSettings,
+                            double sampleRate, int length);
+
+//each band only depends on a couple of the settings, so compare just those
+bool lowCutSettingsDiffer(const ChainSettings& a, const ChainSettings& b);
+bool peakSettingsDiffer(const ChainSettings& a, const ChainSettings& b);
+bool highCutSettingsDiffer(const ChainSettings& a, const ChainSettings& b);
+bool bandSettingsDiffer(const BandSettings& a, const BandSettings& b);
+
+//true if the band passes everything through unchanged (or close enough): the peak at 0db, or a cut parked at the end of its range
+bool isTransparentBand(const ChainSettings& chainSettings, ChainPositions band);
+//an extra band that's off, or a peak or shelf at 0db (a notch always does something)
+bool isTransparentBand(const BandSettings& bandSettings);
+
+//how many samples the band's biquads take to ring out by the given number of decibels once their input stops
+double getBandDecaySamples(const ChainCoefficients& chainCoefficients, ChainPositions band, double decibels);
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate )
-{
-    //low cut means you need the high pass
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                       sampleRate,
-                                                                                       2 * (chainSettings.lowCutSlope + 1));
-}
-
-//do same for high cut
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate )
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                                       sampleRate,
-                                                                                                       2 * (chainSettings.highCutSlope + 1));
-}
 
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+//listen to our own parameters so coefficients only get redesigned (on the message thread) when something moved
+juce::AudioProcessorParameter::Listener,
+juce::Timer
 {
 public:
     //==============================================================================
@@ -206,6 +242,9 @@ public:
     // what happens whenever you hit the play button in the transport control -> host sends buffers at regular rate to plug in.
     // plug in's job is to give back any finished audio that is done processing (don't interrupt chain of events)
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    //hosts that render in 64 bit get the whole cascade in double, not a conversion round trip
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -235,19 +274,320 @@ public:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
-    // since juce dsp library is built to process mono audio, we need to duplicate everything we do for stereo
+    
+    //built once from the apvts, use this instead of string lookups on anything that runs often
+    const ChainParameterHandles& getParameterHandles() const { return parameterHandles; }
+    const BankParameterHandles& getBankParameterHandles() const { return bankParameterHandles; }
+    
+    //parameter callbacks can arrive on the audio thread during automation, so they only set a flag
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
+    
+    //redesigns the coefficients on the message thread whenever the flag was set
+    void timerCallback() override;
+    
+    //how many times a band has been redesigned since the plugin was created (only bands whose inputs changed get redesigned)
+    int getRedesignCount(ChainPositions band) const { return redesignCounts[band].get(); }
+    
+    //automation sweeps keep landing on the same stepped values, so recently designed bands can be reused.
+    //only the message thread's designs go through it, see processSegment for why the ramps don't
+    void setCoefficientCacheEnabled(bool shouldBeEnabled);
+    int getCoefficientCacheHits() const { return coefficientCache.getHits(); }
+    int getCoefficientCacheMisses() const { return coefficientCache.getMisses(); }
+    
+    //parameter moves ramp over rampSeconds instead of jumping once per block (0 turns smoothing off).
+    //while a band ramps it gets redesigned every updateIntervalSamples, so a block costs at most
+    //(block size / updateIntervalSamples) designs per moving band, and nothing once the targets are reached
+    void setSmoothing(double rampSeconds, int updateIntervalSamples);
+    
+    //sample accurate automation. positions count samples since prepareToPlay, and the block gets split so the change lands
+    //on exactly that sample whatever the host's buffer size is (the plugin wrappers only hand us changes between blocks,
+    //so this is for anything that knows the real timestamps, like an offline renderer).
+    //one producer thread only, push in time order. returns false if the queue is full
+    bool pushParameterChange(juce::int64 samplePosition, ChainParameter parameter, float value);
+    
+    //bands that are currently transparent (peak at 0db, a cut parked at the end of its range) get faded out and then
+    //taken out of the kernel, and faded back in when they move. on by default
+    void setNeutralStageElision(bool shouldBeEnabled) { neutralStageElision = shouldBeEnabled; }
+    bool isNeutralStageElisionEnabled() const { return neutralStageElision.load(); }
+    
+    //once the input has been digitally silent for longer than the tail (plus our latency), the state gets flushed and
+    //processBlock skips the filters until sound comes back. on by default
+    void setSilenceDetection(bool shouldBeEnabled) { silenceDetection = shouldBeEnabled; }
+    bool isSleeping() const { return sleeping.load(); }
+    
+    //when every channel carries exactly the same samples as the first (a mono source on a stereo track), only the first
+    //gets filtered and the result is copied to the others. on by default
+    void setDualMonoDetection(bool shouldBeEnabled) { dualMonoDetection = shouldBeEnabled; }
+    bool isProcessingDualMono() const { return dualMonoActive.load(); }
+    
+    //1 with oversampling off, otherwise 2 or 4. the filters get designed for getSampleRate() * this
+    int getOversamplingFactor() const { return oversamplingFactor; }
+    
+    //pre and post eq spectra. the editor enables it while it's open, otherwise processBlock just checks a flag
+    SpectrumAnalyzer& getAnalyzer() { return analyzer; }
+    
+    //how long every processBlock takes against its deadline. on by default, it only costs two clock reads a block
+    DSPLoadMeter& getLoadMeter() { return loadMeter; }
+    //the meter's numbers with the message thread's redesign counts filled in
+    DSPLoadMeter::Stats getLoadStats() const;
+    // juce dsp filters are built to process mono audio, so we run our own kernel with the channels packed into SIMD lanes instead
 private:
     //moved enum to public
-    MonoChain leftChain, rightChain;
+    //enough for 7.1.4 or 3rd order ambisonics on a single instance
+    static constexpr int maxChannels = 16;
+    int numPreparedChannels { 0 };
+    
+    //the fused kernel, its state and its interleaving buffer, one per precision. only the one the host asked for in
+    //prepareToPlay gets allocated, the coefficients are designed in double either way
+    FilterCascade<float> floatCascade;
+    FilterCascade<double> doubleCascade;
+    bool doublePrecisionActive { false };
+    
+    //"Filter Engine": direct form biquads (0) or tpt state variable filters (1), picked in prepareToPlay
+    bool stateVariableActive { false };
+    int preparedFilterEngine { 0 };
+    std::atomic<float>* filterEngineParameter { apvts.getRawParameterValue("Filter Engine") };
+    int getFilterEngineChoice() const { return juce::roundToInt(filterEngineParameter->load()); }
+    
+    template <typename SampleType>
+    FilterCascade<SampleType>& getCascade()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleCascade;
+        else
+            return floatCascade;
+    }
+    
+    //processBlock for either precision
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    //these go to whichever cascade is running. in mid/side mode only the chain's own lane gets the coefficients
+    void setCascadeStage(int slot, const BiquadArray& biquad, StereoChain chain);
+    void setCascadeSVFStage(int slot, const SVFArray& svf, StereoChain chain);
+    void setCascadeStageCounts(const ChainSettings& chainSettings);
+    void resetCascadeStages(int firstSlot, int numSlots);
+    //how long the svf engine takes to glide to the stages written since the last run, see FilterCascade::setSVFRampLength
+    void setCascadeSVFRampLength(int numSamples);
+    
+    //sub block smoothing. frequencies ramp in the log domain (multiplicative), gain and q linearly, slopes just switch
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreqSmoother, highCutFreqSmoother, peakFreqSmoother;
+    juce::SmoothedValue<float> peakGainSmoother, peakQualitySmoother;
+    std::atomic<double> smoothingSeconds { 0.05 };
+    std::atomic<int> smoothingUpdateInterval { 32 };
+    double appliedSmoothingSeconds { -1 };
+    //scratch space for designs made in the middle of a ramp
+    ChainCoefficients rampCoefficients;
+    //where the smoothers are heading, plus the slopes (which don't ramp)
+    ChainSettings targetSettings;
+    //set by timestamped events so the band gets designed at that point even when there's no ramp
+    std::array<bool, 3> bandNeedsDesign {};
+    
+    //timestamped automation and the sample clock it is measured on
+    ParameterEventQueue parameterEvents;
+    juce::int64 samplePosition { 0 };
+    
+    void resetSmoothers(const ChainSettings& chainSettings);
+    bool isRamping(ChainPositions band) const;
+    bool needsDesign(ChainPositions band) const { return bandNeedsDesign[band] || isRamping(band); }
+    
+    //neutral stage elision. each band has a dry / wet weight from 0 (straight through) to 1 (its real design) that glides
+    //towards its target over elisionFadeSamples, so a band never drops out of (or comes back into) the path with a click.
+    //a band that sits at weight 0 gets left out of the kernel once whatever its state still holds has died away
+    std::atomic<bool> neutralStageElision { true };
+    std::array<float, 3> bandWeights { 1.f, 1.f, 1.f }, bandTargetWeights { 1.f, 1.f, 1.f };
+    std::array<bool, 3> bandInKernel { true, true, true };
+    std::array<int, 3> bandHoldSamples {};
+    int elisionFadeSamples { 1 };
+    //the designs the bands were last given (per chain), so a fade can write them again with a new weight
+    std::array<ChainCoefficients, 2> appliedCoefficients;
+    //how far down a filter's ringing has to be before we treat it as gone (for elision, the tail and going to sleep)
+    static constexpr double ringOutDecibels = 80.0;
+    
+    bool isBandTransparent(ChainPositions band) const;
+    bool isElisionMoving() const;
+    bool isCascadeMoving() const;
+    //picks new target weights, putting back any band that has to fade in
+    void updateElision();
+    //moves the fading bands one sub block along and drops the ones that have finished fading out
+    void advanceElision(int numSamples);
+    void updateBand(ChainPositions band, const ChainCoefficients& chainCoefficients, StereoChain chain = MainChain);
+    //writes the band again from appliedCoefficients, for every chain that's running
+    void rewriteBand(ChainPositions band);
+    
+    //silence detection. anything at or below silenceThreshold counts as silent
+    static constexpr float silenceThreshold = 1.0e-6f;
+    std::atomic<bool> silenceDetection { true }, sleeping { false };
+    juce::int64 silentSamples { 0 };
+    //throws away everything the filters (and the oversampler or convolver) are holding
+    void flushState();
+    //while we sleep nothing is audible, so ramps jump straight to their targets and get designed when we wake up
+    void finishRamps();
+    
+    //dual mono. checked every block with an exact compare, a sampled one could miss a difference and filter the wrong thing
+    std::atomic<bool> dualMonoDetection { true }, dualMonoActive { false };
+    //how long the channels have been identical. dual mono only starts once that covers the tail
+    juce::int64 matchingSamples { 0 };
+    //the other channels weren't filtered while it was on, so they pick up the first channel's state when it ends
+    void splitDualMonoState(int numChannels);
+    
+    //the tail the host gets, worked out from the designed filters' pole radii every time they change
+    std::atomic<double> tailLengthSeconds { 0 };
+    juce::Atomic<bool> tailLengthChanged { false };
+    //call with designLock held
+    void updateTailLength();
+    //sets new smoothing targets for the bands the message thread redesigned and copies over the ones that don't need to ramp
+    void startRampTowards(const ChainCoefficients& target);
+    //copies every band that isn't ramping and hasn't been applied yet
+    void applyPublishedBands(const ChainCoefficients& published);
+    //a timestamped change, applied right at its sample
+    void applyParameterEvent(const ParameterEvent& event);
+    //runs part of the block. while something is moving it gets split on a fixed grid of smoothingUpdateInterval samples
+    //(counted from prepareToPlay, so the split points don't depend on the host's buffer size) and the moving bands get redesigned in between
+    void processSegment(int startSample, int numSamples, size_t numGroups);
+    void runCascade(int startSample, int numSamples, size_t numGroups);
     
     //cleaning up stuff that configures peak filter
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    //these run on the audio thread and only copy already designed coefficients into the cascade
+    void updatePeakFilter(const ChainCoefficients& chainCoefficients, StereoChain chain = MainChain);
     
     
    
-    void updateLowCutFilters (const ChainSettings& chainSettings);
-    void updateHighCutFilters (const ChainSettings& chainSettings);
+    void updateLowCutFilters (const ChainCoefficients& chainCoefficients, StereoChain chain = MainChain);
+    void updateHighCutFilters (const ChainCoefficients& chainCoefficients, StereoChain chain = MainChain);
+    
+    //designs a new coefficient set from the apvts and publishes it to the audio thread (never call this from processBlock in real time)
     void updateFilters();
+    //redesigns the bands whose own settings moved (or all of them) into designed, returns true if there were any
+    bool designChangedBands(ChainCoefficients& designed, const ChainSettings& previousSettings,
+                            const ChainSettings& chainSettings, double sampleRate, bool redesignAll);
+    
+    //designed coefficients travel from the message thread to the audio thread through here
+    TripleBuffer<ChainCoefficients> coefficientHandoff;
+    //the audio thread never takes this, it just stops two writers (e.g. timer and setStateInformation) publishing at once
+    juce::CriticalSection designLock;
+    juce::Atomic<bool> parametersChanged { false };
+    
+    //message thread side: what the last published set was designed from (guarded by designLock)
+    ChainCoefficients designedCoefficients;
+    ChainSettings designedSettings;
+    double designedSampleRate { 0 };
+    juce::Atomic<int> redesignCounts[3];
+    CoefficientCache coefficientCache;
+    bool coefficientCacheEnabled { true };
+    
+    SpectrumAnalyzer analyzer;
+    DSPLoadMeter loadMeter;
+    
+    //oversampling, set up in prepareToPlay from the two choice parameters
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    std::unique_ptr<juce::dsp::Oversampling<double>> doubleOversampler;
+    
+    //null with oversampling off (or in the other precision)
+    template <typename SampleType>
+    juce::dsp::Oversampling<SampleType>* getOversampler()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleOversampler.get();
+        else
+            return oversampler.get();
+    }
+    int oversamplingFactor { 1 };
+    int preparedOversampling { 0 }, preparedOversamplingFilter { 0 };
+    std::atomic<float>* oversamplingParameter { apvts.getRawParameterValue("Oversampling") };
+    std::atomic<float>* oversamplingFilterParameter { apvts.getRawParameterValue("Oversampling Filter") };
+    
+    int getOversamplingChoice() const { return juce::roundToInt(oversamplingParameter->load()); }
+    int getOversamplingFilterChoice() const { return juce::roundToInt(oversamplingFilterParameter->load()); }
+    //"Stereo Mode": left/right (0) or mid/side (1), picked in prepareToPlay. mid/side needs exactly two channels and
+    //doesn't apply to linear phase mode. both chains share the kernel, the mid and side lanes just get their own coefficients
+    bool midSideActive { false };
+    int preparedStereoMode { 0 };
+    std::atomic<float>* stereoModeParameter { apvts.getRawParameterValue("Stereo Mode") };
+    int getStereoModeChoice() const { return juce::roundToInt(stereoModeParameter->load()); }
+    
+    //the side chain's designs come through their own handoff. they don't ramp or take timestamped events,
+    //each new design gets applied at the start of the next block
+    TripleBuffer<ChainCoefficients> sideCoefficientHandoff;
+    ChainCoefficients designedSideCoefficients;
+    ChainSettings designedSideSettings;
+    //audio thread side: what the side chain is set to, and the band versions it has
+    ChainSettings sideTargetSettings;
+    std::array<juce::uint32, 3> appliedSideVersions {};
+    void applySideBands(const ChainCoefficients& published);
+    
+    //the extra bands. designed on the message thread like the chain, and moved on the audio thread the same way: a band that
+    //keeps its type ramps its frequency, gain and q with its own smoothers, designed once per cell like the chain's bands.
+    //one that comes on, goes off or changes type fades through a straight wire (same poles, see fadeBiquad) over
+    //elisionFadeSamples instead. a band that has faded out keeps running dry until what's left in its state has rung out,
+    //then gets packed out of the cascade
+    TripleBuffer<BankCoefficients> bankHandoff;
+    BankCoefficients designedBank;
+    //audio thread side: the design each band runs (before its weight), the type that design is, and the fades
+    std::array<juce::uint32, maxParametricBands> appliedBankVersions {};
+    std::array<BiquadArray, maxParametricBands> appliedBankBiquads {};
+    std::array<BandType, maxParametricBands> appliedBankTypes {};
+    std::array<bool, maxParametricBands> bankBandInCascade {}, bankNeedsDesign {};
+    std::array<float, maxParametricBands> bankWeights {}, bankTargetWeights {};
+    std::array<int, maxParametricBands> bankHoldSamples {};
+    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>, maxParametricBands> bankFreqSmoothers;
+    std::array<juce::SmoothedValue<float>, maxParametricBands> bankGainSmoothers, bankQualitySmoothers;
+    //picks up new designs: sets the ramps and fades going, the grid in processSegment moves them
+    void applyBankBands(const BankCoefficients& published);
+    bool isBankRamping(int band) const;
+    bool isBankMoving() const;
+    //for where the band's ramp will be numSamples from now, or the published design once it isn't ramping
+    void designBankBand(int band, int numSamples, const BankCoefficients& published);
+    //moves the fading bands one cell along, swaps in a new type once the old one has faded out,
+    //and takes out the bands that are done ringing out
+    void advanceBankFades(int numSamples, const BankCoefficients& published);
+    //jumps every ramp and fade to where it's heading, for when nothing is listening
+    void finishBankRamps(const BankCoefficients& published);
+    void resetBankSmoothers(double sampleRate, double seconds);
+    void snapBankSmoothers(int band, const BandSettings& bandSettings);
+    //how long the band's current design takes to ring out
+    int getBankHoldSamples(int band) const;
+    //writes the band's design with its weight
+    void writeBankBand(int band);
+    //redesigns the extra bands whose settings moved (or all of them), returns true if there were any
+    bool designChangedBankBands(BankCoefficients& designed, const BankSettings& bankSettings, double sampleRate, bool redesignAll);
+    //these go to whichever cascade is running, every lane gets the same bands
+    void setCascadeBankBand(int band, const BiquadArray& biquad);
+    void removeCascadeBankBand(int band);
+    
+    //the rate the cascade actually runs at
+    double getProcessingSampleRate() const { return getSampleRate() * oversamplingFactor; }
+    //creates (or drops) the oversampler
+    void prepareOversampling(int samplesPerBlock);
+    
+    //linear phase mode: the whole chain becomes one long symmetric fir, run by partitioned fft convolution
+    //instead of the cascade. kernels get designed on kernelThread whenever the settings change
+    LinearPhaseConvolver linearPhase;
+    bool linearPhaseActive { false };
+    int preparedPhaseMode { 0 }, preparedLinearPhaseFftSize { 0 };
+    std::atomic<float>* phaseModeParameter { apvts.getRawParameterValue("Phase Mode") };
+    std::atomic<float>* linearPhaseFftSizeParameter { apvts.getRawParameterValue("Linear Phase FFT Size") };
+    juce::Atomic<bool> linearPhaseKernelWanted { false }, linearPhaseKernelJobRunning { false };
+    //only touched by whoever is designing a kernel
+    std::vector<float> linearPhaseImpulse;
+    
+    int getPhaseModeChoice() const { return juce::roundToInt(phaseModeParameter->load()); }
+    int getLinearPhaseFftSizeChoice() const { return juce::roundToInt(linearPhaseFftSizeParameter->load()); }
+    bool processingSettingsChanged() const;
+    void prepareLinearPhase();
+    void startLinearPhaseKernelJob();
+    void designLinearPhaseKernel(const ChainSettings& chainSettings, const BankSettings& bankSettings);
+    
+    //audio thread side: band versions that are already in the chains
+    std::array<juce::uint32, 3> appliedVersions {};
+    
+    //declared after everything a kernel job touches, so it gets destroyed (and waits for the job) first
+    juce::ThreadPool kernelThread { 1 };
+    
+    //has to come after the apvts since it is built from it
+    ChainParameterHandles parameterHandles { apvts };
+    ChainParameterHandles sideParameterHandles { apvts, "Side " };
+    BankParameterHandles bankParameterHandles { apvts };
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
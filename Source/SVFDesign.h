@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    SVFDesign.h
+    the same peak and butterworth responses as BiquadDesign.h, but as trapezoidal (tpt)
+    state variable filters. a design is one tan, and the filter stays well behaved
+    when its cutoff and damping move every sample
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadDesign.h"
+
+//g and k set up the two integrators, m0, m1, m2 mix the input, band pass and low pass outputs.
+//a ramp moves these and not the integrator gains worked out from them, so every filter along the way is still a tpt svf
+using SVFArray = std::array<double, 5>;
+
+//g is the prewarped cutoff, tan(pi * f / sampleRate), and k is 1 / q (the damping)
+inline SVFArray makeSVF(double g, double k, double m0, double m1, double m2) noexcept
+{
+    return { g, k, m0, m1, m2 };
+}
+
+inline double prewarpSVF(double sampleRate, double frequency) noexcept
+{
+    jassert(sampleRate > 0 && frequency > 0 && frequency < sampleRate * 0.5);
+    return std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+}
+
+//same response as designPeakBiquad (the rbj bell): the damping gets divided by A so the bandwidth matches
+inline SVFArray designPeakSVF(double sampleRate, double frequency, double quality, double gainFactor) noexcept
+{
+    const auto A = std::sqrt(juce::jmax(0.0, gainFactor));
+    const auto k = 1.0 / (quality * A);
+    return makeSVF(prewarpSVF(sampleRate, frequency), k, 1.0, k * (A * A - 1.0), 0.0);
+}
+
+inline SVFArray designHighPassSVF(double sampleRate, double frequency, double quality) noexcept
+{
+    const auto k = 1.0 / quality;
+    return makeSVF(prewarpSVF(sampleRate, frequency), k, 1.0, -k, -1.0);
+}
+
+inline SVFArray designLowPassSVF(double sampleRate, double frequency, double quality) noexcept
+{
+    return makeSVF(prewarpSVF(sampleRate, frequency), 1.0 / quality, 0.0, 0.0, 1.0);
+}
+
+//same sections (and qs) as designButterworthSections
+template <size_t MaxSections>
+void designButterworthSVFSections(std::array<SVFArray, MaxSections>& sections, bool isHighPass,
+                                  double sampleRate, double frequency, int order) noexcept
+{
+    jassert(order / 2 <= (int) MaxSections);
+
+    for (int i = 0; i < order / 2; ++i)
+    {
+        const auto q = butterworthSectionQuality(order, i);
+        sections[(size_t) i] = isHighPass ? designHighPassSVF(sampleRate, frequency, q)
+                                          : designLowPassSVF(sampleRate, frequency, q);
+    }
+}
+
+//dry / wet crossfade through the output mix alone. the state never reaches the output at amount 0,
+//so unlike the biquad version there is nothing left ringing once it gets there
+inline SVFArray fadeSVF(const SVFArray& svf, double amount) noexcept
+{
+    return { svf[0], svf[1], 1.0 + amount * (svf[2] - 1.0), amount * svf[3], amount * svf[4] };
+}
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    pre and post eq spectra for the editor. the audio thread only copies samples into
+    a lock free fifo, the windowed ffts run on their own thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+//single producer / single consumer ring of mono samples
+class AnalyzerFifo
+{
+public:
+    explicit AnalyzerFifo(int capacity = 1 << 16) : fifo(capacity), samples((size_t) capacity) {}
+
+    //audio thread: averages the channels straight into the ring. whatever doesn't fit gets dropped, it never waits
+    template <typename SampleType>
+    void push(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples) noexcept
+    {
+        auto scope = fifo.write(juce::jmin(numSamples, fifo.getFreeSpace()));
+        const auto gain = 1.f / (float) juce::jmax(1, numChannels);
+
+        auto average = [&](int start, int size, int sourceOffset)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                float sum = 0;
+                for (int channel = 0; channel < numChannels; ++channel)
+                    sum += (float) buffer.getReadPointer(channel)[sourceOffset + i];
+                samples[(size_t) (start + i)] = sum * gain;
+            }
+        };
+
+        average(scope.startIndex1, scope.blockSize1, 0);
+        average(scope.startIndex2, scope.blockSize2, scope.blockSize1);
+    }
+
+    //analyzer thread: copies out up to maxSamples, returns how many
+    int pull(float* destination, int maxSamples) noexcept
+    {
+        auto scope = fifo.read(juce::jmin(maxSamples, fifo.getNumReady()));
+        std::copy_n(samples.data() + scope.startIndex1, scope.blockSize1, destination);
+        std::copy_n(samples.data() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    //analyzer thread: throws away whatever is waiting
+    void discard() noexcept { fifo.finishedRead(fifo.getNumReady()); }
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<float> samples;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalyzerFifo)
+};
+
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+    //smoothed magnitudes in dbfs, one per bin from dc up to nyquist
+    struct Spectrum {
+        std::vector<float> pre, post;
+        double binWidth { 0 };
+    };
+
+    SpectrumAnalyzer() : juce::Thread("spectrum analyzer") {}
+    ~SpectrumAnalyzer() override { stopThread(1000); }
+
+    //message thread: the editor turns this on while it's open. while it's off the audio thread only reads one flag
+    void setEnabled(bool shouldBeEnabled)
+    {
+        if (shouldBeEnabled)
+        {
+            active.store(true, std::memory_order_relaxed);
+            startThread();
+        }
+        else
+        {
+            active.store(false, std::memory_order_relaxed);
+            stopThread(1000);
+        }
+    }
+
+    //fft size is 2^order, a new frame every fftSize / overlap samples. picked up by the analyzer thread
+    void setSettings(int order, int overlap)
+    {
+        fftOrder.store(juce::jlimit(minOrder, maxOrder, order));
+        fftOverlap.store(juce::jlimit(1, 16, overlap));
+    }
+
+    void setSampleRate(double sampleRate) { currentSampleRate.store(sampleRate); }
+
+    //audio thread
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+    template <typename SampleType>
+    void pushPre(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples) noexcept { pre.fifo.push(buffer, numChannels, numSamples); }
+    template <typename SampleType>
+    void pushPost(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples) noexcept { post.fifo.push(buffer, numChannels, numSamples); }
+
+    //message thread: true if a new spectrum came in since last time
+    bool pullSpectrum() noexcept { return spectra.pull(); }
+    const Spectrum& getSpectrum() const noexcept { return spectra.getReadBuffer(); }
+
+private:
+    static constexpr int minOrder = 9, maxOrder = 15;
+
+    //one tap point: its fifo, the last fftSize samples and the smoothed result
+    struct Tap {
+        AnalyzerFifo fifo;
+        std::vector<float> history, smoothed;
+        int writePosition { 0 }, samplesUntilFrame { 0 };
+    };
+
+    void run() override
+    {
+        //anything left from the last time the editor was open is stale
+        pre.fifo.discard();
+        post.fifo.discard();
+        int order = 0, overlap = 0;
+        double sampleRate = 0;
+
+        while (! threadShouldExit())
+        {
+            if (order != fftOrder.load() || overlap != fftOverlap.load() || sampleRate != currentSampleRate.load())
+            {
+                order = fftOrder.load();
+                overlap = fftOverlap.load();
+                sampleRate = currentSampleRate.load();
+                configure(order);
+            }
+
+            const auto hop = fftSize / overlap;
+            auto gotFrame = analyze(pre, hop);
+            gotFrame = analyze(post, hop) || gotFrame;
+
+            if (gotFrame && sampleRate > 0)
+            {
+                auto& spectrum = spectra.getWriteBuffer();
+                spectrum.pre = pre.smoothed;
+                spectrum.post = post.smoothed;
+                spectrum.binWidth = sampleRate / fftSize;
+                spectra.publish();
+            }
+
+            //a 60hz display doesn't need anything faster
+            wait(10);
+        }
+    }
+
+    //allocates, but only ever here on the analyzer thread
+    void configure(int order)
+    {
+        fftSize = 1 << order;
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+        fftData.assign((size_t) fftSize * 2, 0.f);
+        scratch.resize((size_t) fftSize);
+
+        for (auto* tap : { &pre, &post })
+        {
+            tap->history.assign((size_t) fftSize, 0.f);
+            tap->smoothed.assign((size_t) fftSize / 2 + 1, -100.f);
+            tap->writePosition = 0;
+            tap->samplesUntilFrame = fftSize;
+        }
+    }
+
+    //reads everything waiting in the tap's fifo, running a frame every hop samples. returns true if it ran any
+    bool analyze(Tap& tap, int hop)
+    {
+        auto gotFrame = false;
+
+        for (;;)
+        {
+            //never read past the next frame boundary so the overlap stays exact
+            const auto numRead = tap.fifo.pull(scratch.data(), tap.samplesUntilFrame);
+            if (numRead == 0)
+                return gotFrame;
+
+            for (int i = 0; i < numRead; ++i)
+            {
+                tap.history[(size_t) tap.writePosition] = scratch[(size_t) i];
+                tap.writePosition = (tap.writePosition + 1) & (fftSize - 1);
+            }
+
+            tap.samplesUntilFrame -= numRead;
+            if (tap.samplesUntilFrame == 0)
+            {
+                runFrame(tap);
+                tap.samplesUntilFrame = hop;
+                gotFrame = true;
+            }
+        }
+    }
+
+    void runFrame(Tap& tap)
+    {
+        //oldest sample first
+        const auto split = (size_t) tap.writePosition;
+        std::copy(tap.history.begin() + (std::ptrdiff_t) split, tap.history.end(), fftData.begin());
+        std::copy(tap.history.begin(), tap.history.begin() + (std::ptrdiff_t) split, fftData.begin() + (std::ptrdiff_t) (fftSize - split));
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.f);
+
+        window->multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+        fft->performFrequencyOnlyForwardTransform(fftData.data());
+
+        //a full scale sine reads 0db: the hann window halves the amplitude and one sided bins halve it again
+        const auto scale = 4.f / (float) fftSize;
+        for (size_t bin = 0; bin < tap.smoothed.size(); ++bin)
+        {
+            const auto level = juce::Decibels::gainToDecibels(fftData[bin] * scale, -100.f);
+            auto& smoothed = tap.smoothed[bin];
+            //jump up straight away, fall back slowly so the display doesn't flicker
+            smoothed = level > smoothed ? level : smoothed + (level - smoothed) * 0.2f;
+        }
+    }
+
+    std::atomic<bool> active { false };
+    std::atomic<int> fftOrder { 11 }, fftOverlap { 4 };
+    std::atomic<double> currentSampleRate { 0 };
+
+    Tap pre, post;
+
+    //analyzer thread only
+    int fftSize { 0 };
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> fftData, scratch;
+
+    TripleBuffer<Spectrum> spectra;
+
+    JUCE_DECLARE_NON_COPYABLE (SpectrumAnalyzer)
+};
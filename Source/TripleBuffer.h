@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    wait free "latest value" slot between one writer thread and one reader thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// the writer fills its back buffer and swaps it with the middle one,
+// the reader swaps the middle one with its front buffer whenever something new is waiting there
+// neither side ever blocks or allocates, and the reader never sees a half written value
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+    //writer side: fill this in, then call publish()
+    ValueType& getWriteBuffer() noexcept { return buffers[backIndex]; }
+
+    void publish() noexcept
+    {
+        //hand the back buffer over (marked as new) and take whatever was in the middle as our next back buffer
+        backIndex = middle.exchange(backIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //reader side: swaps the newest value in if there is one. returns true if the front buffer changed
+    bool pull() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & newDataBit) == 0)
+            return false;
+
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const ValueType& getReadBuffer() const noexcept { return buffers[frontIndex]; }
+
+private:
+    static constexpr int indexMask = 3, newDataBit = 4;
+
+    std::array<ValueType, 3> buffers {};
+    int backIndex = 0, frontIndex = 1;
+    std::atomic<int> middle { 2 };
+};
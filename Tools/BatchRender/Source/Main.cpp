@@ -0,0 +1,354 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    headless batch renderer: runs SimpleEQAudioProcessor over a pile of audio files
+    without a host, one processor per worker thread
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+
+struct RenderOptions {
+    juce::File outputFolder;
+    juce::String suffix { "_eq" };
+    int blockSize { 4096 };
+    int numThreads { 0 };
+    juce::MemoryBlock preset;
+    //parameter id -> plain (not normalised) value, applied on top of the preset
+    juce::StringPairArray parameterValues;
+    juce::File presetToWrite;
+    //per file dsp load, as csv or json depending on the extension
+    juce::File statsOutput;
+};
+
+void printUsage()
+{
+    std::cout << "usage: BatchRender [options] <file or folder>...\n"
+                 "  --output <folder>       where the rendered files go (default: next to each input)\n"
+                 "  --preset <file>         state blob saved by getStateInformation\n"
+                 "  --set \"<id>=<value>\"    sets a parameter, eg --set \"Peak Gain=6\" or --set \"LowCut Slope=2\"\n"
+                 "  --write-preset <file>   saves the resulting state so it can be passed to --preset later\n"
+                 "  --stats <file>          writes each file's processBlock timing, .json or .csv\n"
+                 "  --suffix <text>         added to each output file name (default _eq)\n"
+                 "  --threads <n>           worker threads (default: one per core)\n"
+                 "  --block <n>             samples per processBlock call (default 4096)\n";
+}
+
+//stdout gets shared between the workers
+juce::CriticalSection printLock;
+
+void print(const juce::String& text)
+{
+    const juce::ScopedLock lock(printLock);
+    std::cout << text << std::endl;
+}
+
+bool applySettings(SimpleEQAudioProcessor& processor, const RenderOptions& options)
+{
+    if (options.preset.getSize() > 0)
+        processor.setStateInformation(options.preset.getData(), (int) options.preset.getSize());
+
+    for (auto& id : options.parameterValues.getAllKeys())
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        if (parameter == nullptr)
+        {
+            print("unknown parameter: " + id);
+            return false;
+        }
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(options.parameterValues[id].getFloatValue()));
+    }
+
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormat& format, const juce::File& file)
+{
+    //memory map when the format allows it so big files just page in as we go
+    if (auto mapped = std::unique_ptr<juce::MemoryMappedAudioFormatReader>(format.createMemoryMappedReader(file)))
+        if (mapped->mapEntireFile())
+            return mapped;
+
+    //otherwise read through a buffered stream
+    auto stream = file.createInputStream();
+    if (stream == nullptr)
+        return {};
+
+    return std::unique_ptr<juce::AudioFormatReader>(format.createReaderFor(new juce::BufferedInputStream(stream.release(), 1 << 16, true), true));
+}
+
+juce::Result renderFile(SimpleEQAudioProcessor& processor, juce::AudioFormatManager& formatManager,
+                        const juce::File& input, const RenderOptions& options, DSPLoadMeter::Stats& loadStats)
+{
+    auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+    if (format == nullptr)
+        return juce::Result::fail("unsupported format");
+
+    auto reader = createReader(*format, input);
+    if (reader == nullptr)
+        return juce::Result::fail("couldn't open it");
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sampleRate = reader->sampleRate;
+
+    //same thing a host does before it starts calling processBlock
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if (! processor.setBusesLayout(layout))
+        return juce::Result::fail(juce::String(numChannels) + " channels isn't a supported layout");
+
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+    processor.prepareToPlay(sampleRate, options.blockSize);
+
+    const auto folder = options.outputFolder == juce::File() ? input.getParentDirectory() : options.outputFolder;
+    const auto output = folder.getChildFile(input.getFileNameWithoutExtension() + options.suffix + input.getFileExtension());
+    output.deleteFile();
+
+    auto stream = output.createOutputStream();
+    if (stream == nullptr || stream->failedToOpen())
+        return juce::Result::fail("couldn't write " + output.getFullPathName());
+
+    //keep the source's bit depth when the writer can do it
+    auto bitDepth = (int) reader->bitsPerSample;
+    if (! format->getPossibleBitDepths().contains(bitDepth))
+        bitDepth = 24;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                            bitDepth, reader->metadataValues, 0));
+    if (writer == nullptr)
+        return juce::Result::fail("couldn't create a writer for " + output.getFullPathName());
+
+    //the writer owns the stream now
+    stream.release();
+
+    juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+    juce::MidiBuffer midi;
+
+    //render the tail too, reading past the end of the file just gives us silence.
+    //the first latency samples out are the processor's delay, so they get dropped and the output lines up with the input
+    const auto tailSamples = (juce::int64) std::ceil(processor.getTailLengthSeconds() * sampleRate);
+    const auto latency = (juce::int64) processor.getLatencySamples();
+    const auto totalSamples = reader->lengthInSamples + tailSamples + latency;
+
+    for (juce::int64 position = 0; position < totalSamples; position += options.blockSize)
+    {
+        const auto numSamples = (int) juce::jmin<juce::int64>(options.blockSize, totalSamples - position);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+
+        reader->read(&buffer, 0, numSamples, position, true, true);
+        processor.processBlock(buffer, midi);
+
+        const auto skip = (int) juce::jlimit<juce::int64>(0, numSamples, latency - position);
+        if (! writer->writeFromAudioSampleBuffer(buffer, skip, numSamples - skip))
+            return juce::Result::fail("write failed for " + output.getFullPathName());
+    }
+
+    //prepareToPlay cleared the meter, so this is just this file. a load of 1 here means rendering at real time speed
+    loadStats = processor.getLoadStats();
+    processor.releaseResources();
+    return juce::Result::ok();
+}
+
+//pulls files off the shared list until there are none left, always through its own processor
+struct RenderWorker : juce::Thread
+{
+    RenderWorker(int index, SimpleEQAudioProcessor& processorToUse, const juce::Array<juce::File>& filesToRender,
+                 std::atomic<int>& nextFileToUse, std::atomic<int>& failuresToUse, const RenderOptions& optionsToUse,
+                 std::vector<DSPLoadMeter::Stats>& fileStatsToUse)
+        : juce::Thread("render worker " + juce::String(index)),
+          processor(processorToUse), files(filesToRender), nextFile(nextFileToUse), failures(failuresToUse), options(optionsToUse),
+          fileStats(fileStatsToUse)
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override
+    {
+        for (auto i = nextFile++; i < files.size() && ! threadShouldExit(); i = nextFile++)
+        {
+            const auto& file = files.getReference(i);
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            //each file has its own slot, so the workers never write the same one
+            const auto result = renderFile(processor, formatManager, file, options, fileStats[(size_t) i]);
+
+            if (result.wasOk())
+            {
+                print(file.getFileName() + " done in " + juce::String((juce::Time::getMillisecondCounterHiRes() - start) / 1000.0, 2) + "s");
+            }
+            else
+            {
+                ++failures;
+                print(file.getFileName() + " failed: " + result.getErrorMessage());
+            }
+        }
+    }
+
+    SimpleEQAudioProcessor& processor;
+    const juce::Array<juce::File>& files;
+    std::atomic<int>& nextFile;
+    std::atomic<int>& failures;
+    const RenderOptions& options;
+    std::vector<DSPLoadMeter::Stats>& fileStats;
+    //one each, so the readers and writers never get shared between threads
+    juce::AudioFormatManager formatManager;
+};
+
+//one entry per file that rendered
+bool writeStats(const juce::File& output, const juce::Array<juce::File>& files, const std::vector<DSPLoadMeter::Stats>& fileStats)
+{
+    juce::StringArray names;
+    std::vector<DSPLoadMeter::Stats> rendered;
+    for (int i = 0; i < files.size(); ++i)
+    {
+        if (fileStats[(size_t) i].numBlocks == 0)
+            continue;
+
+        names.add(files[i].getFullPathName());
+        rendered.push_back(fileStats[(size_t) i]);
+    }
+
+    return DSPLoadMeter::writeToFile(output, "file", names, rendered);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    //the processor owns a timer and an apvts, both expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderOptions options;
+    juce::Array<juce::File> files;
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(juce::CharPointer_UTF8(argv[i]));
+        const auto hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+
+        if (arg.startsWith("--") && ! hasValue)
+        {
+            std::cout << arg << " needs a value" << std::endl;
+            return 1;
+        }
+
+        if (arg == "--output")
+        {
+            options.outputFolder = cwd.getChildFile(argv[++i]);
+        }
+        else if (arg == "--preset")
+        {
+            if (! cwd.getChildFile(argv[++i]).loadFileAsData(options.preset))
+            {
+                std::cout << "couldn't read preset " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--set")
+        {
+            const juce::String assignment(juce::CharPointer_UTF8(argv[++i]));
+            options.parameterValues.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                        assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+        else if (arg == "--write-preset")
+        {
+            options.presetToWrite = cwd.getChildFile(argv[++i]);
+        }
+        else if (arg == "--stats")
+        {
+            options.statsOutput = cwd.getChildFile(argv[++i]);
+        }
+        else if (arg == "--suffix")
+        {
+            options.suffix = argv[++i];
+        }
+        else if (arg == "--threads")
+        {
+            options.numThreads = juce::String(argv[++i]).getIntValue();
+        }
+        else if (arg == "--block")
+        {
+            options.blockSize = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        }
+        else
+        {
+            const auto file = cwd.getChildFile(arg);
+            if (file.isDirectory())
+                files.addArray(file.findChildFiles(juce::File::findFiles, true, "*.wav;*.aif;*.aiff"));
+            else
+                files.add(file);
+        }
+    }
+
+    if (files.isEmpty() && options.presetToWrite == juce::File())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.outputFolder != juce::File() && ! options.outputFolder.createDirectory())
+    {
+        std::cout << "couldn't create " << options.outputFolder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto numThreads = juce::jlimit(1, juce::jmax(1, files.size()),
+                                         options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus());
+
+    //processors get made and set up here on the message thread, the workers only ever render with them
+    std::vector<std::unique_ptr<SimpleEQAudioProcessor>> processors;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        processors.push_back(std::make_unique<SimpleEQAudioProcessor>());
+        if (! applySettings(*processors.back(), options))
+            return 1;
+    }
+
+    if (options.presetToWrite != juce::File())
+    {
+        juce::MemoryBlock state;
+        processors.front()->getStateInformation(state);
+        if (! options.presetToWrite.replaceWithData(state.getData(), state.getSize()))
+        {
+            std::cout << "couldn't write " << options.presetToWrite.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    std::atomic<int> nextFile { 0 }, failures { 0 };
+    std::vector<DSPLoadMeter::Stats> fileStats ((size_t) files.size());
+    juce::OwnedArray<RenderWorker> workers;
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < numThreads; ++i)
+        workers.add(new RenderWorker(i, *processors[(size_t) i], files, nextFile, failures, options, fileStats))->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+
+    print(juce::String(files.size() - failures.load()) + " of " + juce::String(files.size()) + " files rendered on "
+          + juce::String(numThreads) + " threads in " + juce::String((juce::Time::getMillisecondCounterHiRes() - start) / 1000.0, 2) + "s");
+
+    if (options.statsOutput != juce::File() && ! writeStats(options.statsOutput, files, fileStats))
+    {
+        std::cout << "couldn't write " << options.statsOutput.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,622 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    headless benchmarks for processBlock, updateFilters and the response curve paint,
+    with json output and a baseline compare so every change can be put next to a number
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace
+{
+
+//timestamp counter where we have one, 0 elsewhere (cycles then get reported as unavailable)
+juce::uint64 readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::uint64) __rdtsc();
+   #else
+    return 0;
+   #endif
+}
+
+struct BenchmarkOptions {
+    double secondsPerCase { 0.5 };
+    int repeats { 5 };
+    bool quick { false };
+    juce::File jsonOutput, baseline, statsOutput;
+    double threshold { 10.0 };
+};
+
+//what each case boils down to. value is ns/sample for processBlock and ns/call for everything else
+struct BenchmarkResult {
+    juce::String name, unit;
+    double value { 0 };
+    double cyclesPerCall { 0 };
+    //what the processor's own load meter saw over the timed blocks (processBlock cases only)
+    bool hasLoadStats { false };
+    DSPLoadMeter::Stats loadStats;
+};
+
+//stopwatch that reads both clocks around whatever is being measured
+struct Measurement {
+    juce::int64 ticks { 0 };
+    juce::uint64 cycles { 0 };
+
+    template <typename Function>
+    void add(Function&& function)
+    {
+        const auto startCycles = readCycleCounter();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        function();
+        ticks += juce::Time::getHighResolutionTicks() - startTicks;
+        cycles += readCycleCounter() - startCycles;
+    }
+
+    double getNanoseconds() const { return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9; }
+};
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void setParameter(SimpleEQAudioProcessor& processor, ChainParameter parameter, float value)
+{
+    auto* p = processor.apvts.getParameter(ChainParameterHandles::getParameterID(parameter));
+    p->setValueNotifyingHost(p->convertTo0to1(value));
+}
+
+//slopes past 48db/Oct go through the steep parameter, the regular one stays at 48 underneath
+void setSlope(SimpleEQAudioProcessor& processor, ChainParameter slopeParameter, ChainParameter steepParameter, int slope)
+{
+    setParameter(processor, slopeParameter, (float) juce::jmin(slope, (int) Slope_48));
+    setParameter(processor, steepParameter, (float) juce::jmax(0, slope - (int) Slope_48));
+}
+
+void setChoice(SimpleEQAudioProcessor& processor, const juce::String& id, int index)
+{
+    auto* p = processor.apvts.getParameter(id);
+    p->setValueNotifyingHost(p->convertTo0to1((float) index));
+}
+
+//switches the first numBands extra bands on as 3db peaks and the rest off
+void setBankBands(SimpleEQAudioProcessor& processor, int numBands)
+{
+    for (int band = 0; band < maxParametricBands; ++band)
+    {
+        setChoice(processor, BankParameterHandles::getParameterID(band, BandTypeParam), band < numBands ? Band_Peak : Band_Off);
+        auto* gain = processor.apvts.getParameter(BankParameterHandles::getParameterID(band, BandGainParam));
+        gain->setValueNotifyingHost(gain->convertTo0to1(3.f));
+    }
+}
+
+void prepare(SimpleEQAudioProcessor& processor, double sampleRate, int blockSize)
+{
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+//what goes in: independent noise per channel, the same noise in every channel, or digital silence
+enum BenchmarkInput {
+    NoiseInput,
+    DualMonoInput,
+    SilentInput
+};
+
+//oversampling is 0 (off), 1 (2x) or 2 (4x), oversamplingFilter indexes the "Oversampling Filter" choices.
+//SampleType picks which processBlock gets timed, the way a host rendering in 32 or 64 bit would call it
+template <typename SampleType = float>
+BenchmarkResult benchmarkProcessBlock(SimpleEQAudioProcessor& processor, const BenchmarkOptions& options,
+                                      double sampleRate, int blockSize, int lowCutSlope, int highCutSlope, bool automated,
+                                      int oversampling = 0, int oversamplingFilter = 0, BenchmarkInput input = NoiseInput)
+{
+    constexpr auto isDouble = std::is_same_v<SampleType, double>;
+    setSlope(processor, LowCutSlopeParam, LowCutSteepSlopeParam, lowCutSlope);
+    setSlope(processor, HighCutSlopeParam, HighCutSteepSlopeParam, highCutSlope);
+    setChoice(processor, "Oversampling", oversampling);
+    setChoice(processor, "Oversampling Filter", oversamplingFilter);
+    processor.setProcessingPrecision(isDouble ? juce::AudioProcessor::doublePrecision : juce::AudioProcessor::singlePrecision);
+    prepare(processor, sampleRate, blockSize);
+
+    //the same noise goes in every block, copied in outside the timed part
+    const auto numChannels = processor.getTotalNumInputChannels();
+    juce::AudioBuffer<SampleType> source(numChannels, blockSize), buffer(numChannels, blockSize);
+    juce::Random random(0x5eed);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            source.setSample(ch, i, input == SilentInput ? (SampleType) 0
+                                  : input == DualMonoInput && ch > 0 ? source.getSample(0, i)
+                                  : (SampleType) (random.nextFloat() * 0.5f - 0.25f));
+
+    juce::MidiBuffer midi;
+    const auto numBlocks = juce::jmax(1, (int) std::ceil(options.secondsPerCase * sampleRate / blockSize));
+    juce::int64 position = 0;
+    
+    //silent cases are about what happens once the tail has rung out, so get that out of the way untimed
+    if (input == SilentInput)
+    {
+        const auto ringOutBlocks = (int) std::ceil(processor.getTailLengthSeconds() * sampleRate / blockSize) + 2;
+        for (int block = 0; block < ringOutBlocks; ++block, position += blockSize)
+        {
+            //the buffer starts out uninitialised, and the processor leaves its own output in it
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, blockSize);
+            processor.processBlock(buffer, midi);
+        }
+    }
+    std::vector<double> nsPerSample, cyclesPerBlock;
+
+    //the first pass only warms things up
+    for (int repeat = 0; repeat <= options.repeats; ++repeat)
+    {
+        Measurement measurement;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            //automated cases sweep the peak and low cut through timestamped changes in the middle of every block
+            if (automated)
+            {
+                const auto phase = (float) (position % (juce::int64) sampleRate) / (float) sampleRate;
+                const auto sweep = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * phase);
+                processor.pushParameterChange(position + blockSize / 2, PeakFreqParam, juce::mapToLog10(sweep, 100.f, 10000.f));
+                processor.pushParameterChange(position + blockSize / 2, LowCutFreqParam, juce::mapToLog10(sweep, 20.f, 400.f));
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.copyFrom(ch, 0, source, ch, 0, blockSize);
+
+            measurement.add([&] { processor.processBlock(buffer, midi); });
+            position += blockSize;
+        }
+
+        if (repeat > 0)
+        {
+            nsPerSample.push_back(measurement.getNanoseconds() / ((double) numBlocks * blockSize));
+            cyclesPerBlock.push_back((double) measurement.cycles / numBlocks);
+        }
+        else
+        {
+            //leave the warm up out of the meter too
+            processor.getLoadMeter().reset();
+        }
+    }
+
+    const auto loadStats = processor.getLoadStats();
+    processor.releaseResources();
+    processor.setProcessingPrecision(juce::AudioProcessor::singlePrecision);
+
+    BenchmarkResult result;
+    result.name << "processBlock/sr=" << (int) sampleRate << "/block=" << blockSize
+                << "/low=" << (lowCutSlope + 1) * 12 << "/high=" << (highCutSlope + 1) * 12
+                << (automated ? "/automated" : "/static");
+    if (input == SilentInput)
+        result.name << "/silent";
+    if (input == DualMonoInput)
+        result.name << "/dual-mono";
+    if (processor.apvts.getParameter("Stereo Mode")->getValue() > 0.5f)
+        result.name << "/mid-side";
+    const auto bankSettings = getBankSettings(processor.getBankParameterHandles());
+    const auto numBands = std::count_if(bankSettings.begin(), bankSettings.end(), [](const BandSettings& band) { return band.type != Band_Off; });
+    if (numBands > 0)
+        result.name << "/bands=" << (int) numBands;
+    if (isDouble)
+        result.name << "/double";
+    if (processor.isNeutralStageElisionEnabled())
+        result.name << "/elision";
+    if (processor.apvts.getParameter("Filter Engine")->getValue() > 0.5f)
+        result.name << "/svf";
+    if (! processor.getLoadMeter().isEnabled())
+        result.name << "/no-load-meter";
+    if (oversampling > 0)
+        result.name << "/os=" << (1 << oversampling) << "x-" << processor.apvts.getParameter("Oversampling Filter")->getCurrentValueAsText().replace(" ", "-");
+    if (processor.apvts.getParameter("Phase Mode")->getValue() > 0.5f)
+        result.name << "/linear-phase-fft=" << processor.apvts.getParameter("Linear Phase FFT Size")->getCurrentValueAsText();
+    result.unit = "ns/sample";
+    result.value = median(nsPerSample);
+    result.cyclesPerCall = median(cyclesPerBlock);
+    result.hasLoadStats = true;
+    result.loadStats = loadStats;
+    return result;
+}
+
+//a redesign on the message thread, driven the same way the timer drives it
+BenchmarkResult benchmarkUpdateFilters(SimpleEQAudioProcessor& processor, const BenchmarkOptions& options,
+                                       double sampleRate, bool cacheEnabled)
+{
+    processor.setCoefficientCacheEnabled(cacheEnabled);
+    setSlope(processor, LowCutSlopeParam, LowCutSteepSlopeParam, Slope_48);
+    setSlope(processor, HighCutSlopeParam, HighCutSteepSlopeParam, Slope_48);
+    prepare(processor, sampleRate, 512);
+
+    constexpr int numCalls = 1000;
+    std::vector<double> nsPerCall, cyclesPerCall;
+
+    for (int repeat = 0; repeat <= options.repeats; ++repeat)
+    {
+        Measurement measurement;
+
+        for (int i = 0; i < numCalls; ++i)
+        {
+            //walk the gain and cut frequencies through their steps, like a knob being dragged
+            setParameter(processor, PeakGainParam, -24.f + 0.5f * (float) (i % 97));
+            setParameter(processor, LowCutFreqParam, 20.f + (float) (i % 200));
+            measurement.add([&] { processor.timerCallback(); });
+        }
+
+        if (repeat > 0)
+        {
+            nsPerCall.push_back(measurement.getNanoseconds() / numCalls);
+            cyclesPerCall.push_back((double) measurement.cycles / numCalls);
+        }
+    }
+
+    processor.releaseResources();
+    processor.setCoefficientCacheEnabled(true);
+
+    BenchmarkResult result;
+    result.name << "updateFilters/sr=" << (int) sampleRate << (cacheEnabled ? "/cache" : "/nocache");
+    result.unit = "ns/call";
+    result.value = median(nsPerCall);
+    result.cyclesPerCall = median(cyclesPerCall);
+    return result;
+}
+
+//paint into an image, either with nothing changed since the last paint or right after a parameter move
+BenchmarkResult benchmarkPaint(SimpleEQAudioProcessor& processor, const BenchmarkOptions& options,
+                               int width, int height, bool parametersChanged)
+{
+    prepare(processor, 48000.0, 512);
+
+    ResponseCurveComponent component(processor);
+    component.setSize(width, height);
+    component.timerCallback();
+
+    juce::Image image(juce::Image::ARGB, width, height, true);
+    constexpr int numPaints = 200;
+    std::vector<double> nsPerCall, cyclesPerCall;
+
+    for (int repeat = 0; repeat <= options.repeats; ++repeat)
+    {
+        Measurement measurement;
+
+        for (int i = 0; i < numPaints; ++i)
+        {
+            if (parametersChanged)
+            {
+                setParameter(processor, PeakGainParam, -24.f + 0.5f * (float) (i % 97));
+                measurement.add([&] { component.timerCallback(); });
+            }
+
+            juce::Graphics g(image);
+            measurement.add([&] { component.paint(g); });
+        }
+
+        if (repeat > 0)
+        {
+            nsPerCall.push_back(measurement.getNanoseconds() / numPaints);
+            cyclesPerCall.push_back((double) measurement.cycles / numPaints);
+        }
+    }
+
+    processor.releaseResources();
+
+    BenchmarkResult result;
+    result.name << "paint/" << width << "x" << height << (parametersChanged ? "/changed" : "/static");
+    result.unit = "ns/call";
+    result.value = median(nsPerCall);
+    result.cyclesPerCall = median(cyclesPerCall);
+    return result;
+}
+
+//the editor's curve evaluation on its own, steepest slopes so every stage is in
+BenchmarkResult benchmarkFrequencyResponse(const BenchmarkOptions& options, int numPoints, bool withPhase)
+{
+    ChainSettings settings;
+    settings.lowCutSlope = Slope_96;
+    settings.highCutSlope = Slope_96;
+    settings.peakGainInDecibels = 6.f;
+
+    std::array<BiquadArray, maxResponseBiquads> biquads;
+    const auto numBiquads = getActiveBiquads(makeChainCoefficients(settings, 48000.0), biquads);
+
+    FrequencyResponse response;
+    response.prepare(numPoints, 20.0, 20000.0, 48000.0);
+    std::vector<float> decibels((size_t) numPoints), phase((size_t) numPoints);
+
+    constexpr int numCalls = 1000;
+    std::vector<double> nsPerCall, cyclesPerCall;
+
+    for (int repeat = 0; repeat <= options.repeats; ++repeat)
+    {
+        Measurement measurement;
+
+        for (int i = 0; i < numCalls; ++i)
+            measurement.add([&] { response.evaluate(biquads.data(), numBiquads, decibels.data(), withPhase ? phase.data() : nullptr); });
+
+        if (repeat > 0)
+        {
+            nsPerCall.push_back(measurement.getNanoseconds() / numCalls);
+            cyclesPerCall.push_back((double) measurement.cycles / numCalls);
+        }
+    }
+
+    BenchmarkResult result;
+    result.name << "frequencyResponse/points=" << numPoints << (withPhase ? "/phase" : "/magnitude");
+    result.unit = "ns/call";
+    result.value = median(nsPerCall);
+    result.cyclesPerCall = median(cyclesPerCall);
+    return result;
+}
+
+juce::var toJson(const std::vector<BenchmarkResult>& results)
+{
+    juce::Array<juce::var> list;
+    for (auto& r : results)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("name", r.name);
+        object->setProperty("unit", r.unit);
+        object->setProperty("value", r.value);
+        //null where there is no cycle counter
+        object->setProperty("cycles", readCycleCounter() != 0 ? juce::var(r.cyclesPerCall) : juce::var());
+        list.add(juce::var(object));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("cores", juce::SystemStats::getNumCpus());
+    root->setProperty("results", list);
+    return juce::var(root);
+}
+
+//prints every case that got slower than the threshold and returns how many did
+int compareWithBaseline(const std::vector<BenchmarkResult>& results, const juce::File& file, double threshold)
+{
+    const auto baseline = juce::JSON::parse(file);
+    std::map<juce::String, double> baselineValues;
+    if (auto* list = baseline["results"].getArray())
+        for (auto& entry : *list)
+            baselineValues[entry["name"].toString()] = (double) entry["value"];
+
+    if (baselineValues.empty())
+    {
+        std::cout << "no results in baseline " << file.getFullPathName() << std::endl;
+        return 0;
+    }
+
+    int regressions = 0;
+    for (auto& r : results)
+    {
+        const auto found = baselineValues.find(r.name);
+        if (found == baselineValues.end() || found->second <= 0)
+            continue;
+
+        const auto change = (r.value - found->second) / found->second * 100.0;
+        if (change > threshold)
+        {
+            ++regressions;
+            std::cout << "REGRESSION " << r.name << ": " << found->second << " -> " << r.value << " " << r.unit
+                      << " (+" << juce::String(change, 1) << "%)" << std::endl;
+        }
+    }
+
+    std::cout << regressions << " regressions above " << threshold << "% against " << file.getFileName() << std::endl;
+    return regressions;
+}
+
+void printUsage()
+{
+    std::cout << "usage: Benchmark [options]\n"
+                 "  --json <file>           write the results as json\n"
+                 "  --baseline <file>       compare against an earlier --json run, exits with 2 on a regression\n"
+                 "  --threshold <percent>   how much slower counts as a regression (default 10)\n"
+                 "  --seconds <s>           audio per processBlock case and repeat (default 0.5)\n"
+                 "  --repeats <n>           timed repeats per case, the median is reported (default 5)\n"
+                 "  --quick                 a handful of block sizes, rates and slopes instead of the full sweep\n"
+                 "  --stats <file>          the processor's own load meter for every processBlock case, .json or .csv\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    //the processor and the response curve both expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    BenchmarkOptions options;
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        const auto hasValue = i + 1 < argc;
+
+        if (arg == "--quick")                        options.quick = true;
+        else if (arg == "--json" && hasValue)        options.jsonOutput = cwd.getChildFile(argv[++i]);
+        else if (arg == "--baseline" && hasValue)    options.baseline = cwd.getChildFile(argv[++i]);
+        else if (arg == "--threshold" && hasValue)   options.threshold = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--seconds" && hasValue)     options.secondsPerCase = juce::jmax(0.001, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--repeats" && hasValue)     options.repeats = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        else if (arg == "--stats" && hasValue)       options.statsOutput = cwd.getChildFile(argv[++i]);
+        else
+        {
+            printUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    std::vector<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    std::vector<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    std::vector<std::pair<int, int>> slopes;
+    for (int low = Slope_12; low <= Slope_48; ++low)
+        for (int high = Slope_12; high <= Slope_48; ++high)
+            slopes.emplace_back(low, high);
+
+    if (options.quick)
+    {
+        blockSizes = { 64, 512, 4096 };
+        sampleRates = { 48000.0, 96000.0 };
+        slopes = { { Slope_12, Slope_12 }, { Slope_48, Slope_48 } };
+    }
+
+    SimpleEQAudioProcessor processor;
+    std::vector<BenchmarkResult> results;
+
+    auto report = [&results](BenchmarkResult result)
+    {
+        std::cout << result.name.paddedRight(' ', 60) << juce::String(result.value, 3).paddedLeft(' ', 14) << " " << result.unit;
+        if (readCycleCounter() != 0)
+            std::cout << juce::String(result.cyclesPerCall, 0).paddedLeft(' ', 14) << " cycles/call";
+        std::cout << std::endl;
+        results.push_back(std::move(result));
+    };
+
+    //the default settings are all transparent, so elision stays off unless a case is about it
+    processor.setNeutralStageElision(false);
+    
+    for (auto sampleRate : sampleRates)
+        for (auto blockSize : blockSizes)
+            for (auto [low, high] : slopes)
+                for (auto automated : { false, true })
+                    report(benchmarkProcessBlock(processor, options, sampleRate, blockSize, low, high, automated));
+
+    //the same steep cases rendered in 64 bit, next to their float numbers above
+    for (auto sampleRate : sampleRates)
+        for (auto blockSize : blockSizes)
+            for (auto automated : { false, true })
+                report(benchmarkProcessBlock<double>(processor, options, sampleRate, blockSize, Slope_48, Slope_48, automated));
+
+    //what oversampling costs on top of the plain 48k / 512 case
+    for (int oversampling = 1; oversampling <= 2; ++oversampling)
+        for (int filter = 0; filter < 4; ++filter)
+            report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_12, Slope_12, false, oversampling, filter));
+    setChoice(processor, "Oversampling", 0);
+    
+    //the state variable engine, where the automated cases are the interesting ones
+    setChoice(processor, "Filter Engine", 1);
+    for (auto [low, high] : { std::pair<int, int> { Slope_12, Slope_12 }, { Slope_48, Slope_48 } })
+        for (auto automated : { false, true })
+            report(benchmarkProcessBlock(processor, options, 48000.0, 512, low, high, automated));
+    setChoice(processor, "Filter Engine", 0);
+    
+    //slopes past 48db/oct, where the sections the fused kernel doesn't cover run after it, in both engines
+    for (int engine = 0; engine < 2; ++engine)
+    {
+        setChoice(processor, "Filter Engine", engine);
+        for (auto [low, high] : { std::pair<int, int> { Slope_72, Slope_72 }, { Slope_96, Slope_96 } })
+            for (auto automated : { false, true })
+                report(benchmarkProcessBlock(processor, options, 48000.0, 512, low, high, automated));
+    }
+    setChoice(processor, "Filter Engine", 0);
+    
+    //an idle instance (default settings) with and without neutral stage elision
+    for (auto elision : { false, true })
+    {
+        processor.setNeutralStageElision(elision);
+        for (auto [low, high] : { std::pair<int, int> { Slope_12, Slope_12 }, { Slope_48, Slope_48 } })
+            report(benchmarkProcessBlock(processor, options, 48000.0, 512, low, high, false));
+    }
+    processor.setNeutralStageElision(false);
+    
+    //digital silence in, once the tail has rung out (elision is off here, so every band is in the tail)
+    for (auto [low, high] : { std::pair<int, int> { Slope_12, Slope_12 }, { Slope_48, Slope_48 } })
+        report(benchmarkProcessBlock(processor, options, 48000.0, 512, low, high, false, 0, 0, SilentInput));
+    
+    //the same noise in both channels, with the cascade and with the convolver (where filtering once saves the most)
+    report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_48, Slope_48, false, 0, 0, DualMonoInput));
+    setChoice(processor, "Phase Mode", 1);
+    for (auto input : { NoiseInput, DualMonoInput })
+        report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_48, Slope_48, false, 0, 0, input));
+    setChoice(processor, "Phase Mode", 0);
+    
+    //mid/side, where the matrix rides along with the interleaving (the side chain keeps its defaults)
+    setChoice(processor, "Stereo Mode", 1);
+    for (auto automated : { false, true })
+        report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_48, Slope_48, automated));
+    setChoice(processor, "Stereo Mode", 0);
+    
+    //the runtime sized bank of extra bands on top of the steep cuts, a few and then all of them
+    for (auto numBands : { 4, maxParametricBands })
+    {
+        setBankBands(processor, numBands);
+        for (auto automated : { false, true })
+            report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_48, Slope_48, automated));
+    }
+    setBankBands(processor, 0);
+    
+    //the load meter switched off, to put next to the same cases in the sweep (where it's on)
+    processor.getLoadMeter().setEnabled(false);
+    for (auto blockSize : { 64, 512 })
+        report(benchmarkProcessBlock(processor, options, 48000.0, blockSize, Slope_12, Slope_12, false));
+    processor.getLoadMeter().setEnabled(true);
+    
+    //and the linear phase convolver at each fft size, same settings
+    setChoice(processor, "Phase Mode", 1);
+    for (int fftSize = 0; fftSize < 5; ++fftSize)
+    {
+        setChoice(processor, "Linear Phase FFT Size", fftSize);
+        report(benchmarkProcessBlock(processor, options, 48000.0, 512, Slope_12, Slope_12, false));
+    }
+    setChoice(processor, "Phase Mode", 0);
+
+    for (auto sampleRate : sampleRates)
+        for (auto cacheEnabled : { true, false })
+            report(benchmarkUpdateFilters(processor, options, sampleRate, cacheEnabled));
+
+    for (auto numPoints : { 300, 1200 })
+        for (auto withPhase : { false, true })
+            report(benchmarkFrequencyResponse(options, numPoints, withPhase));
+
+    for (auto [width, height] : { std::pair<int, int> { 600, 133 }, std::pair<int, int> { 1200, 400 } })
+        for (auto parametersChanged : { false, true })
+            report(benchmarkPaint(processor, options, width, height, parametersChanged));
+
+    if (options.jsonOutput != juce::File())
+    {
+        if (! options.jsonOutput.replaceWithText(juce::JSON::toString(toJson(results))))
+        {
+            std::cout << "couldn't write " << options.jsonOutput.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.statsOutput != juce::File())
+    {
+        juce::StringArray names;
+        std::vector<DSPLoadMeter::Stats> loadStats;
+        for (auto& r : results)
+        {
+            if (! r.hasLoadStats || r.loadStats.numBlocks == 0)
+                continue;
+            
+            names.add(r.name);
+            loadStats.push_back(r.loadStats);
+        }
+        
+        if (! DSPLoadMeter::writeToFile(options.statsOutput, "name", names, loadStats))
+        {
+            std::cout << "couldn't write " << options.statsOutput.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.baseline != juce::File() && compareWithBaseline(results, options.baseline, options.threshold) > 0)
+        return 2;
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    headless checks for the claims the optimisations make: the response curve against a
+    direct complex evaluation, output that doesn't depend on the host's block size, and
+    dual mono that sounds the same as filtering every channel. exits with the number of failures
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+#include <complex>
+
+namespace
+{
+
+//prints one line per check and counts the ones that failed
+struct CheckResults {
+    int numFailed { 0 };
+
+    void report(const juce::String& name, bool passed, const juce::String& details)
+    {
+        std::cout << (passed ? "PASS " : "FAIL ") << name.paddedRight(' ', 48) << details << std::endl;
+        if (! passed)
+            ++numFailed;
+    }
+};
+
+void setParameter(SimpleEQAudioProcessor& processor, const juce::String& id, float value)
+{
+    auto* p = processor.apvts.getParameter(id);
+    p->setValueNotifyingHost(p->convertTo0to1(value));
+}
+
+void setParameter(SimpleEQAudioProcessor& processor, ChainParameter parameter, float value)
+{
+    setParameter(processor, ChainParameterHandles::getParameterID(parameter), value);
+}
+
+void setBandParameter(SimpleEQAudioProcessor& processor, int band, BandParameter parameter, float value)
+{
+    setParameter(processor, BankParameterHandles::getParameterID(band, parameter), value);
+}
+
+//==============================================================================
+//the product of every biquad's b0 + b1 z^-1 + b2 z^-2 over 1 + a1 z^-1 + a2 z^-2, one point at a time in std::complex
+std::complex<double> evaluateDirect(const BiquadArray* biquads, int numBiquads, double frequency, double sampleRate)
+{
+    const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    const auto z1 = std::polar(1.0, -w), z2 = std::polar(1.0, -2.0 * w);
+
+    std::complex<double> response { 1.0, 0.0 };
+    for (int b = 0; b < numBiquads; ++b)
+    {
+        const auto& biquad = biquads[b];
+        response *= (biquad[0] + biquad[1] * z1 + biquad[2] * z2) / (1.0 + biquad[3] * z1 + biquad[4] * z2);
+    }
+    return response;
+}
+
+//FrequencyResponse::evaluate against evaluateDirect, for a chain plus a few extra bands at a few sample rates
+void checkFrequencyResponse(CheckResults& results)
+{
+    //the dB values come out as floats, so anything near float precision is a match. phase only gets compared where the
+    //response is well above the -100 dB floor, below that it's the phase of rounding noise
+    constexpr double maxDecibelError = 1.0e-3, maxPhaseError = 1.0e-4, phaseFloorDecibels = -60.0;
+    constexpr int numPoints = 1200;
+
+    ChainSettings chain;
+    chain.lowCutFreq = 80.f;
+    chain.highCutFreq = 12000.f;
+    chain.lowCutSlope = Slope_96;
+    chain.highCutSlope = Slope_48;
+    chain.peakFreq = 750.f;
+    chain.peakGainInDecibels = 9.f;
+    chain.peakQuality = 4.f;
+
+    BankSettings bank;
+    bank[0] = { Band_LowShelf, 200.f, -6.f, 0.7f };
+    bank[1] = { Band_Notch, 3000.f, 0.f, 8.f };
+    bank[2] = { Band_HighShelf, 8000.f, 4.f, 0.7f };
+
+    for (auto sampleRate : { 44100.0, 96000.0 })
+    {
+        std::array<BiquadArray, maxResponseBiquads> biquads;
+        auto numBiquads = getActiveBiquads(makeChainCoefficients(chain, sampleRate), biquads);
+        numBiquads += getActiveBankBiquads(makeBankCoefficients(bank, sampleRate), biquads.data() + numBiquads);
+
+        FrequencyResponse response;
+        response.prepare(numPoints, 20.0, 20000.0, sampleRate);
+        std::vector<float> decibels((size_t) numPoints), phase((size_t) numPoints);
+        response.evaluate(biquads.data(), numBiquads, decibels.data(), phase.data());
+
+        //the magnitude only path multiplies |N|^2 and |D|^2 instead, it has to agree too
+        std::vector<float> magnitudeOnly((size_t) numPoints);
+        response.evaluate(biquads.data(), numBiquads, magnitudeOnly.data());
+
+        double decibelError = 0, phaseError = 0;
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const auto direct = evaluateDirect(biquads.data(), numBiquads, response.getFrequency(i), sampleRate);
+            const auto directDecibels = juce::jmax(-100.0, 20.0 * std::log10(std::abs(direct)));
+
+            decibelError = juce::jmax(decibelError, std::abs(decibels[(size_t) i] - directDecibels),
+                                      std::abs(magnitudeOnly[(size_t) i] - directDecibels));
+            if (directDecibels > phaseFloorDecibels)
+                phaseError = juce::jmax(phaseError, std::abs(std::remainder(phase[(size_t) i] - std::arg(direct),
+                                                                            juce::MathConstants<double>::twoPi)));
+        }
+
+        juce::String name;
+        name << "frequencyResponse/sr=" << (int) sampleRate << "/biquads=" << numBiquads;
+        results.report(name, decibelError <= maxDecibelError && phaseError <= maxPhaseError,
+                       "max error " + juce::String(decibelError, 9) + " dB, " + juce::String(phaseError, 9) + " rad");
+    }
+}
+
+//==============================================================================
+//a chain with every kind of move in it: steep cuts, a peak that sweeps, a band the elision fades out and back,
+//and extra bands that ramp, switch type and switch off
+void setUpProcessor(SimpleEQAudioProcessor& processor, int engine)
+{
+    setParameter(processor, "Filter Engine", (float) engine);
+    setParameter(processor, LowCutFreqParam, 60.f);
+    setParameter(processor, LowCutSlopeParam, (float) Slope_48);
+    setParameter(processor, LowCutSteepSlopeParam, (float) (Slope_72 - Slope_48));
+    setParameter(processor, HighCutFreqParam, 14000.f);
+    setParameter(processor, HighCutSlopeParam, (float) Slope_24);
+    setParameter(processor, PeakFreqParam, 1000.f);
+    setParameter(processor, PeakGainParam, 6.f);
+    setParameter(processor, PeakQualityParam, 2.f);
+    setBandParameter(processor, 0, BandTypeParam, (float) Band_Peak);
+    setBandParameter(processor, 0, BandGainParam, -4.f);
+    setBandParameter(processor, 1, BandTypeParam, (float) Band_LowShelf);
+    setBandParameter(processor, 1, BandGainParam, 3.f);
+}
+
+//message thread changes only land between blocks, so they happen at these positions, which every block size splits at
+void changeBankBands(SimpleEQAudioProcessor& processor, int change)
+{
+    switch (change)
+    {
+        case 0: setBandParameter(processor, 0, BandFreqParam, 4000.f); setBandParameter(processor, 0, BandGainParam, 5.f); break;
+        case 1: setBandParameter(processor, 1, BandTypeParam, (float) Band_HighShelf); break;
+        case 2: setBandParameter(processor, 0, BandTypeParam, (float) Band_Off); break;
+        case 3: setBandParameter(processor, 2, BandTypeParam, (float) Band_Notch); break;
+        default: break;
+    }
+    processor.timerCallback();
+}
+
+//renders the same noise through a fresh processor, handing it over in blocks of the given sizes (cycled through).
+//the timestamped changes are the same samples whatever the block sizes are
+juce::AudioBuffer<float> renderInBlocks(int engine, const std::vector<int>& blockSizes)
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numSamples = 96000, changeInterval = 12000, maxBlockSize = 512;
+
+    SimpleEQAudioProcessor processor;
+    setUpProcessor(processor, engine);
+    processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+    processor.prepareToPlay(sampleRate, maxBlockSize);
+
+    const auto numChannels = processor.getTotalNumInputChannels();
+    juce::AudioBuffer<float> output(numChannels, numSamples), block(numChannels, maxBlockSize);
+    juce::Random random(0x5eed);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            output.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+    //a peak sweep every 700 samples, the peak going flat (and elided) for a while, and a low cut move
+    struct Change { juce::int64 position; ChainParameter parameter; float value; };
+    std::vector<Change> changes;
+    for (int i = 1; i * 700 < numSamples; ++i)
+        changes.push_back({ i * 700, PeakFreqParam, juce::mapToLog10((float) (i % 40) / 40.f, 200.f, 8000.f) });
+    changes.push_back({ 30001, PeakGainParam, 0.f });
+    changes.push_back({ 50003, PeakGainParam, -8.f });
+    changes.push_back({ 70005, LowCutFreqParam, 250.f });
+    std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b) { return a.position < b.position; });
+
+    juce::MidiBuffer midi;
+    size_t nextChange = 0, nextSize = 0;
+    for (int position = 0; position < numSamples; )
+    {
+        if (position % changeInterval == 0 && position > 0)
+            changeBankBands(processor, position / changeInterval - 1);
+
+        //blocks never run over a message thread change
+        const auto nextBoundary = (position / changeInterval + 1) * changeInterval;
+        const auto blockSize = juce::jmin(blockSizes[nextSize++ % blockSizes.size()], nextBoundary - position, numSamples - position);
+
+        for (; nextChange < changes.size() && changes[nextChange].position < position + blockSize; ++nextChange)
+            processor.pushParameterChange(changes[nextChange].position, changes[nextChange].parameter, changes[nextChange].value);
+
+        block.setSize(numChannels, blockSize, false, false, true);
+        for (int ch = 0; ch < numChannels; ++ch)
+            block.copyFrom(ch, 0, output, ch, position, blockSize);
+        processor.processBlock(block, midi);
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom(ch, position, block, ch, 0, blockSize);
+
+        position += blockSize;
+    }
+
+    processor.releaseResources();
+    return output;
+}
+
+//where the host splits its blocks must never change a single sample, in either engine
+void checkBlockSizeIndependence(CheckResults& results)
+{
+    for (int engine = 0; engine < 2; ++engine)
+    {
+        const auto reference = renderInBlocks(engine, { 512 });
+        const auto split = renderInBlocks(engine, { 37, 100, 1, 256, 13, 64 });
+
+        int numDifferent = 0;
+        for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+                if (reference.getSample(ch, i) != split.getSample(ch, i))
+                    ++numDifferent;
+
+        juce::String name;
+        name << "blockSize/" << (engine == 0 ? "biquad" : "svf") << "/512-vs-mixed";
+        results.report(name, numDifferent == 0, juce::String(numDifferent) + " samples differ");
+    }
+}
+
+//==============================================================================
+//stereo noise that turns into the same noise in both channels. with detection on, the second channel only stops being
+//filtered once its own tail has died away, so the output has to match filtering both channels to within that ring out
+void checkDualMono(CheckResults& results)
+{
+    constexpr double sampleRate = 48000.0, maxErrorDecibels = -80.0;
+    constexpr int blockSize = 256, numSamples = 96000, stereoSamples = 24000;
+
+    juce::AudioBuffer<float> input(2, numSamples);
+    juce::Random random(0x5eed);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        input.setSample(0, i, random.nextFloat() * 0.5f - 0.25f);
+        input.setSample(1, i, i < stereoSamples ? random.nextFloat() * 0.5f - 0.25f : input.getSample(0, i));
+    }
+
+    auto render = [&](bool detection, bool& engaged)
+    {
+        SimpleEQAudioProcessor processor;
+        setUpProcessor(processor, 0);
+        processor.setDualMonoDetection(detection);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> output(input), block(2, blockSize);
+        juce::MidiBuffer midi;
+        engaged = false;
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                block.copyFrom(ch, 0, input, ch, position, blockSize);
+            processor.processBlock(block, midi);
+            engaged = engaged || processor.isProcessingDualMono();
+            for (int ch = 0; ch < 2; ++ch)
+                output.copyFrom(ch, position, block, ch, 0, blockSize);
+        }
+
+        processor.releaseResources();
+        return output;
+    };
+
+    bool engaged = false, engagedWithout = false;
+    const auto dualMono = render(true, engaged);
+    const auto stereo = render(false, engagedWithout);
+
+    double maxError = 0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            maxError = juce::jmax(maxError, (double) std::abs(dualMono.getSample(ch, i) - stereo.getSample(ch, i)));
+
+    const auto errorDecibels = juce::Decibels::gainToDecibels(maxError, -200.0);
+    results.report("dualMono/stereo-then-identical", engaged && ! engagedWithout && errorDecibels <= maxErrorDecibels,
+                   juce::String(engaged ? "engaged" : "never engaged") + ", max error " + juce::String(errorDecibels, 1) + " dBFS");
+}
+
+} // namespace
+
+int main()
+{
+    //the processor expects a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    CheckResults results;
+    checkFrequencyResponse(results);
+    checkBlockSizeIndependence(results);
+    checkDualMono(results);
+
+    std::cout << results.numFailed << " failed" << std::endl;
+    return results.numFailed;
+}